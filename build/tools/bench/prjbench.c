@@ -0,0 +1,76 @@
+// round-trip benchmark of the text project format: tic_project_save / tic_project_load
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "project.h"
+
+static void fillCart(tic_cartridge* cart)
+{
+	memset(cart, 0, sizeof(tic_cartridge));
+
+	srand(0);
+
+	for(s32 b = 0; b < TIC_BANKS; b++)
+	{
+		u8* bank = (u8*)&cart->banks[b];
+
+		for(s32 i = 0; i < sizeof(tic_bank); i++)
+			bank[i] = rand();
+	}
+
+	for(s32 i = 0; i < TIC_CODE_SIZE / 2; i++)
+		cart->code.data[i] = i % 64 == 63 ? '\n' : 'a' + i % 26;
+
+	cart->cover.size = 4096;
+	for(s32 i = 0; i < cart->cover.size; i++)
+		cart->cover.data[i] = rand();
+}
+
+static double now()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char** argv)
+{
+	int iterations = argc > 1 ? atoi(argv[1]) : 20;
+
+	tic_cartridge* cart = malloc(sizeof(tic_cartridge));
+	tic_cartridge* loaded = malloc(sizeof(tic_cartridge));
+	char* buffer = malloc(sizeof(tic_cartridge) * 3);
+
+	if(!cart || !loaded || !buffer || iterations <= 0)
+		return -1;
+
+	fillCart(cart);
+
+	s32 size = 0;
+
+	double start = now();
+	for(int i = 0; i < iterations; i++)
+		size = tic_project_save("--", buffer, cart);
+	double save = (now() - start) / iterations;
+
+	start = now();
+	for(int i = 0; i < iterations; i++)
+	{
+		memset(loaded, 0, sizeof(tic_cartridge));
+		tic_project_load("--", buffer, size, loaded);
+	}
+	double load = (now() - start) / iterations;
+
+	int equal = memcmp(cart, loaded, sizeof(tic_cartridge)) == 0;
+
+	printf("{\"bench\": \"project\", \"size\": %i, \"iterations\": %i, "
+		"\"save_ms\": %.3f, \"load_ms\": %.3f, \"load_mb_s\": %.2f, \"roundtrip\": %s}\n",
+		size, iterations, save * 1000, load * 1000, size / load / (1024 * 1024), equal ? "true" : "false");
+
+	free(buffer);
+	free(loaded);
+	free(cart);
+
+	return equal ? 0 : 1;
+}
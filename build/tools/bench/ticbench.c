@@ -0,0 +1,265 @@
+// microbenchmarks of the tic_api primitives, prints ns/op and throughput as JSON for baseline diffs
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ticapi.h"
+
+typedef struct Bench Bench;
+
+struct Bench
+{
+	const char* name;
+	void(*run)(tic_mem* tic, const Bench* bench, s32 i);
+
+	// pixels touched by one op, 0 when it doesn't make sense
+	s32 pixels;
+
+	bool map;
+	tic_flip flip;
+	tic_rotate rotate;
+	s32 scale;
+};
+
+static void benchPixel(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.pixel(tic, i % TIC80_WIDTH, i / TIC80_WIDTH % TIC80_HEIGHT, i % TIC_PALETTE_SIZE);
+}
+
+static void benchLine(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.line(tic, 0, 0, TIC80_WIDTH - 1, TIC80_HEIGHT - 1, i % TIC_PALETTE_SIZE);
+}
+
+static void benchRect(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.rect(tic, 20, 20, 200, 96, i % TIC_PALETTE_SIZE);
+}
+
+static void benchRectBorder(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.rect_border(tic, 20, 20, 200, 96, i % TIC_PALETTE_SIZE);
+}
+
+static void benchCircle(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.circle(tic, TIC80_WIDTH / 2, TIC80_HEIGHT / 2, 60, i % TIC_PALETTE_SIZE);
+}
+
+static void benchCircleBorder(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.circle_border(tic, TIC80_WIDTH / 2, TIC80_HEIGHT / 2, 60, i % TIC_PALETTE_SIZE);
+}
+
+static void benchTri(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.tri(tic, 0, 0, TIC80_WIDTH, 0, 0, TIC80_HEIGHT, i % TIC_PALETTE_SIZE);
+}
+
+static void benchTexTri(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.textri(tic, 0, 0, TIC80_WIDTH, 0, 0, TIC80_HEIGHT, 0, 0, 128, 0, 0, 128, bench->map, 0);
+}
+
+static void benchSprite(tic_mem* tic, const Bench* bench, s32 i)
+{
+	static u8 colors[] = {0};
+	tic->api.sprite_ex(tic, &tic->ram.tiles, i % TIC_BANK_SPRITES, 40, 20, 2, 2, colors, COUNT_OF(colors),
+		bench->scale, bench->flip, bench->rotate);
+}
+
+static void benchMap(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.map(tic, &tic->ram.map, &tic->ram.tiles, i % TIC_MAP_SCREEN_WIDTH, 0,
+		TIC_MAP_SCREEN_WIDTH, TIC_MAP_SCREEN_HEIGHT, 0, 0, 0, 1);
+}
+
+static void remapTile(void* data, s32 x, s32 y, RemapResult* result)
+{
+	result->flip = (x ^ y) & 1 ? tic_horz_flip : tic_no_flip;
+}
+
+static void benchRemap(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.remap(tic, &tic->ram.map, &tic->ram.tiles, i % TIC_MAP_SCREEN_WIDTH, 0,
+		TIC_MAP_SCREEN_WIDTH, TIC_MAP_SCREEN_HEIGHT, 0, 0, 0, 1, remapTile, NULL);
+}
+
+static const char Text[] = "THE QUICK BROWN FOX JUMPS OVER 0123456789";
+
+static void benchText(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.text(tic, Text, 0, 64, i % TIC_PALETTE_SIZE, false);
+}
+
+static void benchFixedText(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.fixed_text(tic, Text, 0, 64, i % TIC_PALETTE_SIZE, false);
+}
+
+static void scanline(tic_mem* tic, s32 row, void* data)
+{
+	tic->ram.vram.palette.colors[0].r = row;
+}
+
+static void overline(tic_mem* tic, void* data) {}
+
+static void benchBlit(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.blit(tic, NULL, NULL, NULL);
+}
+
+static void benchBlitCallbacks(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.blit(tic, scanline, overline, NULL);
+}
+
+static u8* CartBuffer = NULL;
+static s32 CartSize = 0;
+
+static void benchSave(tic_mem* tic, const Bench* bench, s32 i)
+{
+	CartSize = tic->api.save(&tic->cart, CartBuffer);
+}
+
+static void benchLoad(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.load(&tic->cart, CartBuffer, CartSize);
+}
+
+static void playChannels(tic_mem* tic)
+{
+	for(s32 c = 0; c < TIC_SOUND_CHANNELS; c++)
+		tic->api.sfx_ex(tic, 0, c * 3, 4, -1, c, MAX_VOLUME, 0);
+}
+
+// a whole sound frame, the channels are restarted every time so tick_end never synthesizes silence
+static void benchSoundFrame(tic_mem* tic, const Bench* bench, s32 i)
+{
+	tic->api.tick_start(tic, &tic->ram.sfx, &tic->ram.music);
+	playChannels(tic);
+	tic->api.tick_end(tic);
+}
+
+#define SPRITE(name, flip, rotate, scale) {name, benchSprite, 16*16*(scale)*(scale), false, flip, rotate, scale}
+
+static const Bench Benches[] =
+{
+	{"pixel",						benchPixel,						1},
+	{"line",						benchLine,						TIC80_WIDTH},
+	{"rect",						benchRect,						200*96},
+	{"rect_border",					benchRectBorder,				2*(200+96)},
+	{"circle",						benchCircle,					11310},
+	{"circle_border",				benchCircleBorder,				377},
+	{"tri",							benchTri,						TIC80_WIDTH*TIC80_HEIGHT/2},
+	{"textri sheet",				benchTexTri,					TIC80_WIDTH*TIC80_HEIGHT/2, false},
+	{"textri map",					benchTexTri,					TIC80_WIDTH*TIC80_HEIGHT/2, true},
+	SPRITE("sprite_ex",				tic_no_flip,					tic_no_rotate, 1),
+	SPRITE("sprite_ex flip=h",		tic_horz_flip,					tic_no_rotate, 1),
+	SPRITE("sprite_ex flip=v",		tic_vert_flip,					tic_no_rotate, 1),
+	SPRITE("sprite_ex flip=hv",		tic_horz_flip | tic_vert_flip,	tic_no_rotate, 1),
+	SPRITE("sprite_ex rotate=90",	tic_no_flip,					tic_90_rotate, 1),
+	SPRITE("sprite_ex rotate=180",	tic_no_flip,					tic_180_rotate, 1),
+	SPRITE("sprite_ex rotate=270",	tic_no_flip,					tic_270_rotate, 1),
+	SPRITE("sprite_ex scale=2",		tic_no_flip,					tic_no_rotate, 2),
+	SPRITE("sprite_ex scale=4",		tic_no_flip,					tic_no_rotate, 4),
+	{"map",							benchMap,						TIC80_WIDTH*TIC80_HEIGHT},
+	{"remap",						benchRemap,						TIC80_WIDTH*TIC80_HEIGHT},
+	{"text",						benchText,						0},
+	{"fixed_text",					benchFixedText,					0},
+	{"blit",						benchBlit,						TIC80_FULLWIDTH*TIC80_FULLHEIGHT},
+	{"blit callbacks",				benchBlitCallbacks,				TIC80_FULLWIDTH*TIC80_FULLHEIGHT},
+	{"save",						benchSave,						0},
+	{"load",						benchLoad,						0},
+	{"tick_start+tick_end",			benchSoundFrame,				0},
+};
+
+#undef SPRITE
+
+static double now()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static void fillRandom(void* data, s32 size)
+{
+	for(s32 i = 0; i < size; i++)
+		((u8*)data)[i] = rand();
+}
+
+static void fillMemory(tic_mem* tic)
+{
+	srand(0);
+
+	fillRandom(&tic->ram.tiles, sizeof(tic_tiles));
+	fillRandom(&tic->ram.map, sizeof(tic_map));
+	fillRandom(&tic->ram.sfx.waveforms, sizeof(tic_waveforms));
+
+	memcpy(&tic->cart.bank0.tiles, &tic->ram.tiles, sizeof(tic_tiles));
+	memcpy(&tic->cart.bank0.map, &tic->ram.map, sizeof(tic_map));
+
+	for(s32 i = 0; i < TIC_CODE_SIZE / 2; i++)
+		tic->cart.code.data[i] = i % 64 == 63 ? '\n' : 'a' + i % 26;
+}
+
+int main(int argc, char** argv)
+{
+	double minTime = (argc > 1 ? atoi(argv[1]) : 200) / 1000.0;
+	const char* filter = argc > 2 ? argv[2] : NULL;
+
+	tic_mem* tic = tic_create(TIC80_SAMPLERATE);
+	CartBuffer = malloc(sizeof(tic_cartridge) * 2);
+
+	if(!tic || !CartBuffer || minTime <= 0)
+		return -1;
+
+	fillMemory(tic);
+	CartSize = tic->api.save(&tic->cart, CartBuffer);
+
+	printf("{\"bench\": \"api\", \"results\": [");
+
+	bool first = true;
+
+	for(s32 b = 0; b < (s32)COUNT_OF(Benches); b++)
+	{
+		const Bench* bench = &Benches[b];
+
+		if(filter && strstr(bench->name, filter) != bench->name)
+			continue;
+
+		s32 iterations = 1;
+		double elapsed = 0;
+
+		// double the run until it's long enough to trust the clock
+		while(true)
+		{
+			tic->api.tick_start(tic, &tic->ram.sfx, &tic->ram.music);
+
+			double start = now();
+			for(s32 i = 0; i < iterations; i++)
+				bench->run(tic, bench, i);
+			elapsed = now() - start;
+
+			if(elapsed >= minTime || iterations >= 1 << 30)
+				break;
+
+			iterations *= 2;
+		}
+
+		double ns = elapsed * 1e9 / iterations;
+
+		printf("%s\n{\"name\": \"%s\", \"iterations\": %i, \"ns_op\": %.1f, \"ops_s\": %.0f, \"mpix_s\": %.2f}",
+			first ? "" : ",", bench->name, iterations, ns, 1e9 / ns, bench->pixels * 1e3 / ns);
+
+		first = false;
+	}
+
+	printf("\n]}\n");
+
+	free(CartBuffer);
+	tic_close(tic);
+
+	return 0;
+}
@@ -0,0 +1,225 @@
+// drives the net request queue against net-server, checks completion, revalidation, cancel and close,
+// prints timings as JSON for baseline diffs
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "net.h"
+
+#define MAX_REQUESTS 1024
+#define TICK_PERIOD 1000 // us, stands in for the frontend frame
+#define TICK_LIMIT 30000
+
+typedef struct
+{
+	s32 id;
+	s32 size;
+	HttpGetStatus status;
+	bool called;
+	bool cached;
+	bool valid;
+} Call;
+
+static Call Calls[MAX_REQUESTS];
+static s32 Pending = 0;
+static s32 Cancelled = 0;
+static s32 Failures = 0;
+
+static double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void check(bool condition, const char* what)
+{
+	if(!condition)
+	{
+		fprintf(stderr, "FAILED: %s\n", what);
+		Failures++;
+	}
+}
+
+// same generator as net-server's /bytes/<size>
+static bool validBytes(const char* url, const u8* data, s32 size)
+{
+	const char* path = strstr(url, "/bytes/");
+
+	u32 seed = 2166136261u;
+	for(const char* it = path; it && *it && *it != '?'; it++)
+		seed = (seed ^ (u8)*it) * 16777619u;
+
+	for(s32 i = 0; i < size; i++)
+		if(data[i] != (u8)((seed >> (i % 4 * 8)) + i))
+			return false;
+
+	return path != NULL;
+}
+
+static void onGet(const HttpGetData* data)
+{
+	Call* call = (Call*)data->calldata;
+
+	call->called = true;
+	call->status = data->status;
+	call->cached = data->cached;
+	call->size = data->size;
+	call->valid = data->status == HttpGetDone && validBytes(data->url, data->data, data->size);
+
+	Pending--;
+}
+
+static void onClosed(const HttpGetData* data)
+{
+	// like surf's cover requests, calldata belongs to the callback
+	free(data->calldata);
+
+	if(data->status == HttpGetCancel)
+		Cancelled++;
+
+	Pending--;
+}
+
+static void queue(Net* net, s32 count, s32 size, const char* query)
+{
+	memset(Calls, 0, sizeof Calls);
+
+	for(s32 i = 0; i < count; i++)
+	{
+		char path[256];
+		snprintf(path, sizeof path, "/bytes/%i?i=%i%s", size + i, i, query);
+
+		Calls[i].id = netGet(net, path, onGet, &Calls[i]);
+		Pending++;
+	}
+}
+
+static double run(Net* net)
+{
+	double start = now();
+
+	for(s32 i = 0; Pending > 0 && i < TICK_LIMIT; i++)
+	{
+		netTick(net);
+
+		if(Pending > 0)
+			usleep(TICK_PERIOD);
+	}
+
+	check(Pending == 0, "every request called back");
+
+	return now() - start;
+}
+
+static void print(const char* name, s32 count, double elapsed, bool* first)
+{
+	printf("%s\n{\"name\": \"%s\", \"requests\": %i, \"ms\": %.2f, \"ms_request\": %.3f}",
+		*first ? "" : ",", name, count, elapsed * 1e3, elapsed * 1e3 / count);
+
+	*first = false;
+}
+
+int main(int argc, char** argv)
+{
+	const char* host = argc > 1 ? argv[1] : "http://127.0.0.1:8080";
+	s32 count = argc > 2 ? atoi(argv[2]) : 64;
+	s32 size = argc > 3 ? atoi(argv[3]) : 16 * 1024;
+
+	if(count <= 0 || count > MAX_REQUESTS / 2 || size < 0)
+		return -1;
+
+	Net* net = createNet(host);
+
+	printf("{\"bench\": \"net\", \"host\": \"%s\", \"results\": [", host);
+
+	bool first = true;
+
+	{
+		queue(net, count, size, "");
+		double elapsed = run(net);
+
+		for(s32 i = 0; i < count; i++)
+		{
+			check(Calls[i].called && Calls[i].status == HttpGetDone, "cold request done");
+			check(Calls[i].valid && Calls[i].size == size + i, "cold body matches");
+			check(!Calls[i].cached, "cold request not from cache");
+		}
+
+		print("cold", count, elapsed, &first);
+	}
+
+	{
+		queue(net, count, size, "");
+		double elapsed = run(net);
+
+		for(s32 i = 0; i < count; i++)
+		{
+			check(Calls[i].called && Calls[i].status == HttpGetDone, "revalidated request done");
+			check(Calls[i].cached && Calls[i].valid, "revalidated body comes from cache");
+		}
+
+		print("revalidate", count, elapsed, &first);
+	}
+
+	{
+		queue(net, count, size, "&delay=20&cancel");
+
+		// every other request is dropped, those never call back
+		for(s32 i = 0; i < count; i += 2)
+		{
+			netCancel(net, Calls[i].id);
+			Pending--;
+		}
+
+		double elapsed = run(net);
+
+		for(s32 i = 0; i < count; i++)
+			check(Calls[i].called == (i % 2 == 1), "only requests left in the queue call back");
+
+		print("cancel", count, elapsed, &first);
+	}
+
+	{
+		double start = now();
+
+		for(s32 i = 0; i < count; i++)
+		{
+			char path[256];
+			snprintf(path, sizeof path, "/bytes/%i?blocking=%i", size, i);
+
+			s32 got = 0;
+			void* data = netGetRequest(net, path, &got);
+
+			check(data && got == size, "blocking request done");
+			free(data);
+		}
+
+		print("blocking", count, now() - start, &first);
+	}
+
+	{
+		// calldata owned by pending requests has to come back when the net closes
+		for(s32 i = 0; i < count; i++)
+		{
+			char path[256];
+			snprintf(path, sizeof path, "/bytes/%i?delay=1000&close=%i", size, i);
+			netGet(net, path, onClosed, malloc(sizeof(Call)));
+			Pending++;
+		}
+
+		double start = now();
+		closeNet(net);
+
+		check(Pending == 0 && Cancelled == count, "close cancelled every pending request");
+
+		print("close", count, now() - start, &first);
+	}
+
+	printf("\n], \"failures\": %i}\n", Failures);
+
+	return Failures ? -1 : 0;
+}
@@ -0,0 +1,338 @@
+// local stand-in for the TIC-80 site, point the studio or net-bench at it with TIC80_HOST=http://127.0.0.1:<port>
+//
+// GET /bytes/<size>[?delay=<ms>]	<size> generated bytes, the same for the same path
+// GET /<path>[?delay=<ms>]			a file under the root folder (current folder by default)
+//
+// responses carry Content-Length, ETag and Last-Modified, matching If-None-Match or
+// If-Modified-Since get a 304, connections are kept alive
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define REQUEST_SIZE 8192
+#define HEADER_SIZE 128
+#define MAX_BYTES (64 * 1024 * 1024)
+
+static const char* Root = ".";
+
+typedef struct
+{
+	char method[16];
+	char path[1024];
+	char query[1024];
+	char etag[HEADER_SIZE];
+	char modified[HEADER_SIZE];
+	bool close;
+} Request;
+
+typedef struct
+{
+	uint8_t* data;
+	size_t size;
+	char etag[HEADER_SIZE];
+	char modified[HEADER_SIZE];
+} Body;
+
+static uint32_t hash(const char* text)
+{
+	uint32_t value = 2166136261u;
+
+	while(*text)
+		value = (value ^ (uint8_t)*text++) * 16777619u;
+
+	return value;
+}
+
+static bool sendAll(int fd, const void* data, size_t size)
+{
+	const uint8_t* ptr = data;
+
+	while(size)
+	{
+		ssize_t sent = send(fd, ptr, size, MSG_NOSIGNAL);
+
+		if(sent <= 0)
+			return false;
+
+		ptr += sent;
+		size -= sent;
+	}
+
+	return true;
+}
+
+static void readHeader(const char* line, const char* name, char* value)
+{
+	size_t length = strlen(name);
+
+	if(strncasecmp(line, name, length) == 0 && line[length] == ':')
+	{
+		line += length + 1;
+		while(*line == ' ') line++;
+
+		snprintf(value, HEADER_SIZE, "%.*s", (int)strcspn(line, "\r\n"), line);
+	}
+}
+
+static bool parseRequest(char* text, Request* request)
+{
+	memset(request, 0, sizeof(Request));
+
+	char target[2048] = {0};
+	char version[16] = {0};
+
+	if(sscanf(text, "%15s %2047s %15s", request->method, target, version) != 3)
+		return false;
+
+	char* query = strchr(target, '?');
+
+	if(query)
+	{
+		*query++ = '\0';
+		snprintf(request->query, sizeof request->query, "%s", query);
+	}
+
+	snprintf(request->path, sizeof request->path, "%s", target);
+
+	request->close = strcmp(version, "HTTP/1.0") == 0;
+
+	for(char* line = strstr(text, "\r\n"); line && line[2]; line = strstr(line + 2, "\r\n"))
+	{
+		char connection[HEADER_SIZE] = {0};
+
+		readHeader(line + 2, "If-None-Match", request->etag);
+		readHeader(line + 2, "If-Modified-Since", request->modified);
+		readHeader(line + 2, "Connection", connection);
+
+		if(strcasecmp(connection, "close") == 0)
+			request->close = true;
+	}
+
+	return true;
+}
+
+static long getQuery(const Request* request, const char* name)
+{
+	size_t length = strlen(name);
+
+	for(const char* it = request->query; it && *it; it = strchr(it, '&'), it = it ? it + 1 : NULL)
+		if(strncmp(it, name, length) == 0 && it[length] == '=')
+			return atol(it + length + 1);
+
+	return 0;
+}
+
+static void formatDate(time_t date, char* buffer)
+{
+	struct tm tm;
+	gmtime_r(&date, &tm);
+	strftime(buffer, HEADER_SIZE, "%a, %d %b %Y %H:%M:%S GMT", &tm);
+}
+
+static bool makeBytes(const Request* request, Body* body)
+{
+	long size = atol(request->path + strlen("/bytes/"));
+
+	if(size < 0 || size > MAX_BYTES)
+		return false;
+
+	body->size = size;
+	body->data = malloc(size ? size : 1);
+
+	if(!body->data)
+		return false;
+
+	uint32_t seed = hash(request->path);
+
+	for(long i = 0; i < size; i++)
+		body->data[i] = (uint8_t)((seed >> (i % 4 * 8)) + i);
+
+	snprintf(body->etag, HEADER_SIZE, "\"%08x-%lx\"", seed, size);
+	formatDate(0, body->modified);
+
+	return true;
+}
+
+static bool readFile(const Request* request, Body* body)
+{
+	if(strstr(request->path, ".."))
+		return false;
+
+	char path[2048];
+	snprintf(path, sizeof path, "%s%s", Root, request->path);
+
+	struct stat st;
+	if(stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+		return false;
+
+	FILE* file = fopen(path, "rb");
+
+	if(!file)
+		return false;
+
+	body->size = st.st_size;
+	body->data = malloc(body->size ? body->size : 1);
+
+	bool done = body->data && fread(body->data, 1, body->size, file) == body->size;
+
+	fclose(file);
+
+	snprintf(body->etag, HEADER_SIZE, "\"%lx-%lx\"", (long)st.st_mtime, (long)st.st_size);
+	formatDate(st.st_mtime, body->modified);
+
+	return done;
+}
+
+static bool respond(int fd, const Request* request)
+{
+	long delay = getQuery(request, "delay");
+
+	if(delay > 0)
+		usleep(delay * 1000);
+
+	Body body = {0};
+
+	bool found = strcmp(request->method, "GET") == 0
+		&& (strncmp(request->path, "/bytes/", strlen("/bytes/")) == 0
+			? makeBytes(request, &body)
+			: readFile(request, &body));
+
+	const char* status = "404 Not Found";
+
+	if(found)
+	{
+		bool notModified = strlen(request->etag)
+			? strcmp(request->etag, body.etag) == 0
+			: strlen(request->modified) && strcmp(request->modified, body.modified) == 0;
+
+		status = notModified ? "304 Not Modified" : "200 OK";
+
+		if(notModified)
+			body.size = 0;
+	}
+	else body.size = 0;
+
+	char header[1024];
+	int length = snprintf(header, sizeof header,
+		"HTTP/1.1 %s\r\n"
+		"Content-Length: %zu\r\n"
+		"Content-Type: application/octet-stream\r\n"
+		"%s%s%s"
+		"%s%s%s"
+		"Connection: %s\r\n"
+		"\r\n",
+		status, body.size,
+		found ? "ETag: " : "", found ? body.etag : "", found ? "\r\n" : "",
+		found ? "Last-Modified: " : "", found ? body.modified : "", found ? "\r\n" : "",
+		request->close ? "close" : "keep-alive");
+
+	bool done = sendAll(fd, header, length) && sendAll(fd, body.data, body.size);
+
+	printf("%s %s%s%s %.3s %zu\n", request->method, request->path, strlen(request->query) ? "?" : "", request->query, status, body.size);
+
+	free(body.data);
+
+	return done && !request->close;
+}
+
+static void* serve(void* data)
+{
+	int fd = (int)(intptr_t)data;
+
+	char buffer[REQUEST_SIZE];
+	size_t size = 0;
+
+	while(true)
+	{
+		char* end = NULL;
+
+		while(!(end = strstr(buffer, "\r\n\r\n")))
+		{
+			if(size == sizeof buffer - 1)
+				goto done;
+
+			ssize_t got = recv(fd, buffer + size, sizeof buffer - 1 - size, 0);
+
+			if(got <= 0)
+				goto done;
+
+			size += got;
+			buffer[size] = '\0';
+		}
+
+		end += strlen("\r\n\r\n");
+
+		Request request;
+		if(!parseRequest(buffer, &request) || !respond(fd, &request))
+			break;
+
+		// pipelined requests stay in the buffer
+		size -= end - buffer;
+		memmove(buffer, end, size);
+		buffer[size] = '\0';
+	}
+
+done:
+	close(fd);
+
+	return NULL;
+}
+
+int main(int argc, char** argv)
+{
+	int port = argc > 1 ? atoi(argv[1]) : 8080;
+
+	if(argc > 2)
+		Root = argv[2];
+
+	signal(SIGPIPE, SIG_IGN);
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	int server = socket(AF_INET, SOCK_STREAM, 0);
+
+	if(server < 0)
+		return -1;
+
+	int yes = 1;
+	setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes);
+
+	struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+
+	if(bind(server, (struct sockaddr*)&addr, sizeof addr) != 0 || listen(server, 16) != 0)
+	{
+		fprintf(stderr, "can't listen on 127.0.0.1:%i\n", port);
+		return -1;
+	}
+
+	printf("serving %s on http://127.0.0.1:%i\n", Root, port);
+
+	while(true)
+	{
+		int fd = accept(server, NULL, NULL);
+
+		if(fd < 0)
+			continue;
+
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+
+		pthread_t thread;
+		if(pthread_create(&thread, NULL, serve, (void*)(intptr_t)fd) == 0)
+			pthread_detach(thread);
+		else close(fd);
+	}
+
+	return 0;
+}
@@ -0,0 +1,127 @@
+// headless playback of an input replay recorded with tic80_record_start, checks the frame hashes
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tic80.h"
+#include "replay.h"
+#include "tracing.h"
+
+static void* readFile(const char* path, u32* size)
+{
+	void* data = NULL;
+	FILE* file = fopen(path, "rb");
+
+	if(file)
+	{
+		fseek(file, 0, SEEK_END);
+		*size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+
+		data = malloc(*size);
+
+		if(data && fread(data, *size, 1, file) != 1)
+		{
+			free(data);
+			data = NULL;
+		}
+
+		fclose(file);
+	}
+
+	return data;
+}
+
+static double now()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static u64 traceCounter()
+{
+	return clock();
+}
+
+static u64 traceFreq()
+{
+	return CLOCKS_PER_SEC;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc < 3)
+	{
+		fprintf(stderr, "usage: tic80-replay <cart.tic> <replay> [--no-check] [--trace <file>]\n");
+		return -1;
+	}
+
+	bool check = true;
+	const char* trace = NULL;
+
+	for(s32 i = 3; i < argc; i++)
+	{
+		if(strcmp(argv[i], "--no-check") == 0)
+			check = false;
+		else if(strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+			trace = argv[++i];
+	}
+
+	u32 cartSize = 0, dataSize = 0;
+	void* cart = readFile(argv[1], &cartSize);
+	void* data = readFile(argv[2], &dataSize);
+	Replay* replay = data ? replay_open(data, dataSize) : NULL;
+
+	if(!cart || !replay)
+	{
+		fprintf(stderr, "can't load %s\n", cart ? argv[2] : argv[1]);
+		return -1;
+	}
+
+	ReplayInfo info = replay_info(replay);
+
+	if(info.cart != replay_cart_hash(cart, cartSize))
+	{
+		fprintf(stderr, "%s was recorded with another cart\n", argv[2]);
+		return -1;
+	}
+
+	tic80* tic = tic80_create(info.samplerate);
+	tic80_load(tic, cart, cartSize);
+	replay_seed(info.seed);
+
+	tic_mem* memory = ((tic80_local*)tic)->memory;
+	tic80_input input;
+	s32 mismatch = -1;
+
+	if(trace && !tracing_start(trace, traceCounter, traceFreq))
+		fprintf(stderr, "can't open %s\n", trace);
+
+	double start = now();
+
+	for(s32 frame = 0; replay_input(replay, &input); frame++)
+	{
+		TRACE_BEGIN("frame");
+		tic80_tick(tic, input);
+		TRACE_END("frame");
+
+		if(check && mismatch < 0 && !replay_verify(replay, memory))
+			mismatch = frame;
+	}
+
+	double elapsed = now() - start;
+
+	tracing_stop();
+
+	printf("{\"replay\": \"%s\", \"frames\": %u, \"hash_period\": %u, \"ms_per_frame\": %.3f, \"checked\": %s, \"mismatch\": %i}\n",
+		argv[2], info.frames, info.period, info.frames ? elapsed * 1000 / info.frames : 0, 
+		check ? "true" : "false", mismatch);
+
+	tic80_delete(tic);
+	replay_delete(replay);
+	free(data);
+	free(cart);
+
+	return mismatch < 0 ? 0 : 1;
+}
@@ -126,11 +126,52 @@ typedef struct
 
 } tic80_input;
 
+typedef enum
+{
+	TIC80_PIXEL_ABGR8888,
+	TIC80_PIXEL_ARGB8888,
+	TIC80_PIXEL_RGB565,
+	TIC80_PIXEL_INDEXED4,
+} tic80_pixel_format;
+
 TIC80_API tic80* tic80_create(s32 samplerate);
 TIC80_API void tic80_load(tic80* tic, void* cart, s32 size);
 TIC80_API void tic80_tick(tic80* tic, tic80_input input);
+
+// Stepping for frames nobody sees or hears: the game logic, SCN and OVR still run so the state stays
+// the same as with tic80_tick, only the screen conversion and the sound synthesis are skipped.
+// tic80_run_frames steps `frames` frames with the same input, only the last one is stepped with `flags`.
+#define TIC80_SKIP_BLIT (1 << 0)
+#define TIC80_SKIP_AUDIO (1 << 1)
+
+TIC80_API void tic80_step(tic80* tic, tic80_input input, u32 flags);
+TIC80_API void tic80_run_frames(tic80* tic, tic80_input input, s32 frames, u32 flags);
 TIC80_API void tic80_delete(tic80* tic);
 
+// Input replays: after tic80_record_start every tic80_tick input is kept with the cart hash, the random
+// seed and periodic VRAM and sound hashes. Start right after tic80_load, time() only counts ticks here so
+// the same input and seed run the cart through the same frames. The stop returns a malloc'ed buffer.
+TIC80_API void tic80_record_start(tic80* tic, u32 seed);
+TIC80_API void* tic80_record_stop(tic80* tic, u32* size);
+
+// Blit output: by default `screen` gets the whole ABGR8888 frame with the border. An embedder can pass
+// its own buffer, row pitch in bytes and format instead, OVR draws straight into it as well. INDEXED4 packs
+// two palette indices per byte, low nibble first, and tic80_palette returns the ABGR8888 colors the frame
+// ended with. NULL pixels switch back to `screen`.
+TIC80_API void tic80_set_framebuffer(tic80* tic, void* pixels, s32 pitch, tic80_pixel_format format, bool border);
+TIC80_API const u32* tic80_palette(tic80* tic);
+
+// bytes of the instance state that are actually used (script VM heap isn't included)
+TIC80_API u32 tic80_resident_size(tic80* tic);
+
+// Machine snapshot: RAM, input holds, clip, sound registers, sfx and music playback and the frame counter,
+// stored in a versioned little-endian format. The script VM heap can't be serialized, so it keeps running
+// with its current globals and only what the cart keeps in RAM or pmem is restored. A snapshot taken in
+// another session resumes once the same cart is loaded: the code is initialized again on the next tick.
+TIC80_API u32 tic80_state_size(tic80* tic);
+TIC80_API u32 tic80_save_state(tic80* tic, void* buffer, u32 size);
+TIC80_API bool tic80_load_state(tic80* tic, const void* buffer, u32 size);
+
 #ifdef __cplusplus
 }
 #endif
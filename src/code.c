@@ -40,12 +40,6 @@ struct OutlineItem
 #define OUTLINE_SIZE ((TIC80_HEIGHT - TOOLBAR_SIZE*2)/TIC_FONT_HEIGHT)
 #define OUTLINE_ITEMS_SIZE (OUTLINE_SIZE * sizeof(OutlineItem))
 
-static void history(Code* code)
-{
-	if(history_add(code->history))
-		history_add(code->cursorHistory);
-}
-
 static void drawStatus(Code* code)
 {
 	const s32 Height = TIC_FONT_HEIGHT + 1;
@@ -58,6 +52,26 @@ static void drawBookmarks(Code* code)
 	code->tic->api.rect(code->tic, 0, TOOLBAR_SIZE, BOOKMARK_WIDTH, TIC80_HEIGHT - TOOLBAR_SIZE, tic_color_14);
 }
 
+// heat bars of the last profiled run, scaled to the hottest line
+static void drawProfile(Code* code, s32 line, s32 y)
+{
+	const tic_profile* profile = getProfile();
+
+	if(!profile) return;
+
+	u32 max = 0;
+	for(s32 i = 0; i < code->index.count && i < COUNT_OF(profile->lines); i++)
+		max = MAX(max, profile->lines[i]);
+
+	for(; line < code->index.count && line < COUNT_OF(profile->lines) && y < TIC80_HEIGHT; line++, y += STUDIO_TEXT_HEIGHT)
+	{
+		u32 hits = profile->lines[line];
+
+		if(hits && y >= TOOLBAR_SIZE)
+			code->tic->api.rect(code->tic, 0, y, MAX(1, hits * (BOOKMARK_WIDTH - 1) / max), TIC_FONT_HEIGHT, tic_color_2);
+	}
+}
+
 static inline s32 getFontWidth(Code* code)
 {
 	return code->altFont ? TIC_ALTFONT_WIDTH : TIC_FONT_WIDTH;
@@ -83,19 +97,25 @@ static void drawCode(Code* code, bool withCursor)
 {
 	drawBookmarks(code);
 
+	// start from the first line that can reach the screen
+	s32 first = code->scroll.y - (code->rect.y + TIC_FONT_HEIGHT) / STUDIO_TEXT_HEIGHT;
+	first = MAX(MIN(first, code->index.count - 1), 0);
+
 	s32 xStart = code->rect.x - code->scroll.x * (getFontWidth(code));
 	s32 x = xStart;
-	s32 y = code->rect.y - code->scroll.y * STUDIO_TEXT_HEIGHT;
-	char* pointer = code->src;
+	s32 y = code->rect.y + (first - code->scroll.y) * STUDIO_TEXT_HEIGHT;
+	char* pointer = code->src + code->index.lines[first];
 
-	u8* colorPointer = code->colorBuffer;
+	drawProfile(code, first, y);
+
+	u8* colorPointer = code->colorBuffer + code->index.lines[first];
 
 	struct { char* start; char* end; } selection = {MIN(code->cursor.selection, code->cursor.position),
 		MAX(code->cursor.selection, code->cursor.position)};
 
 	struct { s32 x; s32 y; char symbol;	} cursor = {-1, -1, 0};
 
-	while(*pointer)
+	while(*pointer && y < TIC80_HEIGHT)
 	{
 		char symbol = *pointer;
 
@@ -139,38 +159,32 @@ static void drawCode(Code* code, bool withCursor)
 		drawCursor(code, cursor.x, cursor.y, cursor.symbol);
 }
 
-static void getCursorPosition(Code* code, s32* x, s32* y)
+static s32 getLineIndex(Code* code, const char* pos)
 {
-	*x = 0;
-	*y = 0;
+	const s32* lines = code->index.lines;
+	s32 offset = (s32)(pos - code->src);
+	s32 low = 0, high = code->index.count - 1;
 
-	const char* pointer = code->src;
-
-	while(*pointer)
+	while(low < high)
 	{
-		if(code->cursor.position == pointer) return;
-
-		if(*pointer == '\n')
-		{
-			*x = 0;
-			(*y)++;
-		}
-		else (*x)++;
+		s32 mid = (low + high + 1) / 2;
 
-		pointer++;
+		if(lines[mid] <= offset) low = mid;
+		else high = mid - 1;
 	}
+
+	return low;
 }
 
-static s32 getLinesCount(Code* code)
+static void getCursorPosition(Code* code, s32* x, s32* y)
 {
-	char* text = code->src;
-	s32 count = 0;
-
-	while(*text)
-		if(*text++ == '\n')
-			count++;
+	*y = getLineIndex(code, code->cursor.position);
+	*x = (s32)(code->cursor.position - code->src) - code->index.lines[*y];
+}
 
-	return count;
+static s32 getLinesCount(Code* code)
+{
+	return code->index.count - 1;
 }
 
 static void removeInvalidChars(char* code)
@@ -207,38 +221,139 @@ static void updateEditor(Code* code)
 		sprintf(status, "line %i/%i col %i", line + 1, count + 1, column + 1);
 		memcpy(code->status, status, strlen(status));
 
-		size_t codeLen = strlen(code->src);
-		sprintf(status, "%i/%i", (u32)codeLen, TIC_CODE_SIZE);
+		sprintf(status, "%i/%i", code->index.size, TIC_CODE_SIZE);
 
-		memset(code->src + codeLen, '\0', TIC_CODE_SIZE - codeLen);
 		memcpy(code->status + sizeof code->status - strlen(status) - 1, status, strlen(status));
 	}
 }
 
 static inline bool isalnum_(char c) {return isalnum(c) || c == '_';}
 
-static void parseSyntaxColor(Code* code)
+static void updateLines(Code* code, s32 head, s32 tail, s32 prevSize, s32 size)
 {
-	memset(code->colorBuffer, getConfig()->theme.code.syntax.var, sizeof(code->colorBuffer));
+	s32* lines = code->index.lines;
+	s32 count = code->index.count;
+
+	// line starts in (head, prevSize - tail] are replaced with the ones in (head, size - tail]
+	s32 first = getLineIndex(code, code->src + head) + 1;
+	s32 last = first;
+	while(last < count && lines[last] <= prevSize - tail) last++;
+
+	s32 added = 0;
+	for(s32 i = head; i < size - tail; i++)
+		if(code->src[i] == '\n') added++;
+
+	memmove(lines + first + added, lines + last, (count - last) * sizeof(s32));
+
+	count += added - (last - first);
 
+	for(s32 i = first + added; i < count; i++)
+		lines[i] += size - prevSize;
+
+	for(s32 i = head; i < size - tail; i++)
+		if(code->src[i] == '\n')
+			lines[first++] = i + 1;
+
+	code->index.count = count;
+}
+
+static void parseSyntaxColor(Code* code, s32 head, s32 tail, s32 prevSize, s32 size)
+{
 	tic_mem* tic = code->tic;
 
 	const tic_script_config* config = tic->api.get_script_config(tic);
+	const tic_code_theme* theme = &getConfig()->theme.code.syntax;
+	const char* text = code->src;
+
+	if(!config->parse)
+	{
+		memset(code->colorBuffer, theme->var, sizeof(code->colorBuffer));
+		return;
+	}
+
+	if(code->syntax.config != config || memcmp(&code->syntax.theme, theme, sizeof(tic_code_theme)))
+	{
+		code->syntax.config = config;
+		code->syntax.theme = *theme;
+		head = tail = 0;
+	}
+	else if(head == prevSize && head == size)
+		return;
+
+	// re-lex from the first touched line until the state matches the one saved behind the change
+	s32 pos = code->index.lines[getLineIndex(code, text + head)];
+	tic_parse_state state = pos ? code->syntax.state[pos] : tic_parse_none;
 
-	if(config->parse)
-		config->parse(config, code->src, code->colorBuffer, &getConfig()->theme.code.syntax);
+	memmove(code->colorBuffer + size - tail, code->colorBuffer + prevSize - tail, tail + 1);
+	memmove(code->syntax.state + size - tail, code->syntax.state + prevSize - tail, tail + 1);
+	code->syntax.state[pos] = state;
+
+	while(true)
+	{
+		s32 end = pos;
+		while(text[end] && text[end] != '\n') end++;
+
+		memset(code->colorBuffer + pos, theme->var, end - pos + 1);
+		state = config->parse(config, text + pos, code->colorBuffer + pos, theme, state);
+
+		if(!text[end]) break;
+
+		pos = end + 1;
+
+		if(end >= size - tail && code->syntax.state[pos] == state) break;
+
+		code->syntax.state[pos] = state;
+	}
 }
 
-static char* getLineByPos(Code* code, char* pos)
+// `merge` lets typed characters join the last undo step, text replaced from outside never does
+static void updateText(Code* code, bool record, bool merge)
 {
-	char* text = code->src;
-	char* line = text;
+	const char* prev = code->index.src;
+	const char* text = code->src;
+
+	// find the changed range against the last seen text
+	s32 prevSize = code->index.size;
+	s32 size = (s32)strlen(text);
+	s32 head = 0, tail = 0;
+
+	while(head < prevSize && head < size && prev[head] == text[head]) head++;
+
+	while(tail < prevSize - head && tail < size - head
+		&& prev[prevSize - tail - 1] == text[size - tail - 1]) tail++;
+
+	if(head < prevSize || head < size)
+		updateLines(code, head, tail, prevSize, size);
+
+	parseSyntaxColor(code, head, tail, prevSize, size);
+
+	if(record && (head < prevSize || head < size))
+	{
+		s32 removed = prevSize - tail - head;
+		s32 inserted = size - tail - head;
+
+		// single typed or erased characters join one undo step until a line break
+		merge = merge && removed + inserted == 1 && (removed ? prev[head] : text[head]) != '\n';
 
-	while(text < pos)
-		if(*text++ == '\n')
-			line = text;
+		history_replace(code->history, head, prev + head, removed, inserted, merge);
+	}
+
+	// the cart keeps the bytes behind the text zeroed, only the part the text shrank from needs clearing
+	if(size < prevSize)
+		memset(code->src + size, '\0', prevSize - size);
+
+	memcpy(code->index.src + head, text + head, size - head + 1);
+	code->index.size = size;
+}
+
+static void history(Code* code)
+{
+	updateText(code, true, true);
+}
 
-	return line;
+static char* getLineByPos(Code* code, char* pos)
+{
+	return code->src + code->index.lines[getLineIndex(code, pos)];
 }
 
 static char* getLine(Code* code)
@@ -248,19 +363,9 @@ static char* getLine(Code* code)
 
 static char* getPrevLine(Code* code)
 {
-	char* text = code->src;
-	char* pos = code->cursor.position;
-	char* prevLine = text;
-	char* line = text;
-
-	while(text < pos)
-		if(*text++ == '\n')
-		{
-			prevLine = line;
-			line = text;
-		}
+	s32 line = getLineIndex(code, code->cursor.position);
 
-	return prevLine;
+	return code->src + code->index.lines[line > 0 ? line - 1 : 0];
 }
 
 static char* getNextLineByPos(Code* code, char* pos)
@@ -297,35 +402,14 @@ static void updateCursorPosition(Code* code, char* position)
 
 static void setCursorPosition(Code* code, s32 cx, s32 cy)
 {
-	s32 x = 0;
-	s32 y = 0;
-	char* pointer = code->src;
-
-	while(*pointer)
+	if(cy >= 0 && cy < code->index.count)
 	{
-		if(y == cy && x == cx)
-		{
-			updateCursorPosition(code, pointer);
-			return;
-		}
-
-		if(*pointer == '\n')
-		{
-			if(y == cy && cx > x)
-			{
-				updateCursorPosition(code, pointer);
-				return;
-			}
-
-			x = 0;
-			y++;
-		}
-		else x++;
+		char* line = code->src + code->index.lines[cy];
+		s32 size = getLineSize(line);
 
-		pointer++;
+		updateCursorPosition(code, line + MAX(MIN(cx, size), 0));
 	}
-
-	updateCursorPosition(code, pointer);
+	else updateCursorPosition(code, code->src + code->index.size);
 }
 
 static void upLine(Code* code)
@@ -460,8 +544,6 @@ static bool replaceSelection(Code* code)
 
 		history(code);
 
-		parseSyntaxColor(code);
-
 		return true;
 	}
 
@@ -475,7 +557,6 @@ static void deleteChar(Code* code)
 		char* pos = code->cursor.position;
 		memmove(pos, pos + 1, strlen(pos));
 		history(code);
-		parseSyntaxColor(code);
 	}
 }
 
@@ -486,7 +567,6 @@ static void backspaceChar(Code* code)
 		char* pos = --code->cursor.position;
 		memmove(pos, pos + 1, strlen(pos));
 		history(code);
-		parseSyntaxColor(code);
 	}
 }
 
@@ -501,7 +581,6 @@ static void deleteWord(Code* code)
 		else while(pos < end && !isalnum_(*pos)) pos++;
 		memmove(code->cursor.position, pos, strlen(pos) + 1);
 		history(code);
-		parseSyntaxColor(code);
 	}
 }
 
@@ -517,13 +596,12 @@ static void backspaceWord(Code* code)
 		memmove(pos, code->cursor.position, strlen(code->cursor.position) + 1);
 		code->cursor.position = pos;
 		history(code);
-		parseSyntaxColor(code);
 	}
 }
 
 static void inputSymbolBase(Code* code, char sym)
 {
-	if (strlen(code->src) >= sizeof(tic_code))
+	if (strlen(code->src) >= sizeof(tic_code) - 1)
 		return;
 
 	char* pos = code->cursor.position;
@@ -535,8 +613,6 @@ static void inputSymbolBase(Code* code, char sym)
 	history(code);
 
 	updateColumn(code);
-
-	parseSyntaxColor(code);
 }
 
 static void inputSymbol(Code* code, char sym)
@@ -635,9 +711,9 @@ static void copyFromClipboard(Code* code)
 				{
 					size_t codeSize = strlen(code->src);
 
-					if (codeSize + size > sizeof(tic_code))
+					if (codeSize + size >= sizeof(tic_code))
 					{
-						size = sizeof(tic_code) - codeSize;
+						size = sizeof(tic_code) - codeSize - 1;
 						clipboard[size] = '\0';
 					}
 				}
@@ -648,8 +724,6 @@ static void copyFromClipboard(Code* code)
 				code->cursor.position += size;
 
 				history(code);
-
-				parseSyntaxColor(code);
 			}
 
 			getSystem()->freeClipboardText(clipboard);
@@ -659,24 +733,34 @@ static void copyFromClipboard(Code* code)
 
 static void update(Code* code)
 {
+	// reloaded or replaced code becomes its own undo step, so the history stays in sync with it
+	updateText(code, true, false);
 	updateEditor(code);
-	parseSyntaxColor(code);
 }
 
-static void undo(Code* code)
+static void updateHistory(Code* code, s32 pos)
 {
-	history_undo(code->history);
-	history_undo(code->cursorHistory);
+	updateText(code, false, false);
 
-	update(code);
+	// put the cursor behind the restored text
+	if(pos >= 0)
+	{
+		code->cursor.position = code->src + pos;
+		code->cursor.selection = NULL;
+		updateColumn(code);
+	}
+
+	updateEditor(code);
 }
 
-static void redo(Code* code)
+static void undo(Code* code)
 {
-	history_redo(code->history);
-	history_redo(code->cursorHistory);
+	updateHistory(code, history_undo(code->history));
+}
 
-	update(code);
+static void redo(Code* code)
+{
+	updateHistory(code, history_redo(code->history));
 }
 
 static void doTab(Code* code, bool shift, bool crtl)
@@ -736,7 +820,6 @@ static void doTab(Code* code, bool shift, bool crtl)
 			else if (start <= end) code->cursor.position = end;
 			
 			history(code);
-			parseSyntaxColor(code);
 		}
 	}
 	else inputSymbolBase(code, '\t');
@@ -970,8 +1053,6 @@ static void commentLine(Code* code)
 	code->cursor.selection = NULL;	
 
 	history(code);
-
-	parseSyntaxColor(code);
 }
 
 static void processKeyboard(Code* code)
@@ -1338,6 +1419,7 @@ static void drawOutlineBar(Code* code, s32 x, s32 y)
 	code->tic->api.rect(code->tic, rect.x-1, rect.y, rect.w+1, rect.h, tic_color_14);
 
 	OutlineItem* ptr = code->outline.items;
+	const tic_profile* profile = getProfile();
 
 	y++;
 
@@ -1359,6 +1441,19 @@ static void drawOutlineBar(Code* code, s32 x, s32 y)
 
 			drawFilterMatch(code, x+4, y, buffer, filter);
 
+			if(profile && profile->functions[getLineIndex(code, ptr->pos)])
+			{
+				char hits[sizeof "100%"];
+				sprintf(hits, "%i%%", (s32)(profile->functions[getLineIndex(code, ptr->pos)] * 100.0 / profile->samples));
+
+				s32 hx = TIC80_WIDTH - (s32)strlen(hits) * TIC_FONT_WIDTH - 1;
+
+				if(getConfig()->theme.code.shadow)
+					code->tic->api.fixed_text(code->tic, hits, hx+1, y+1, tic_color_0, false);
+
+				code->tic->api.fixed_text(code->tic, hits, hx, y, tic_color_4, false);
+			}
+
 			ptr++;
 			y += STUDIO_TEXT_HEIGHT;
 		}
@@ -1592,8 +1687,17 @@ void initCode(Code* code, tic_mem* tic, tic_code* src)
 	if(code->outline.items == NULL)
 		code->outline.items = (OutlineItem*)malloc(OUTLINE_ITEMS_SIZE);
 
+	if(code->index.src == NULL)
+	{
+		code->index.src = (char*)malloc(TIC_CODE_SIZE);
+		code->index.lines = (s32*)malloc(TIC_CODE_SIZE * sizeof(s32));
+		code->syntax.state = (u8*)malloc(TIC_CODE_SIZE);
+	}
+
+	code->index.src[0] = '\0';
+	code->index.lines[0] = 0;
+
 	if(code->history) history_delete(code->history);
-	if(code->cursorHistory) history_delete(code->cursorHistory);
 
 	*code = (Code)
 	{
@@ -1606,7 +1710,6 @@ void initCode(Code* code, tic_mem* tic, tic_code* src)
 		.scroll = {0, 0, {0, 0}, false},
 		.tickCounter = 0,
 		.history = NULL,
-		.cursorHistory = NULL,
 		.mode = TEXT_EDIT_MODE,
 		.jump = {.line = -1},
 		.popup =
@@ -1619,13 +1722,38 @@ void initCode(Code* code, tic_mem* tic, tic_code* src)
 			.items = code->outline.items,
 			.index = 0,
 		},
+		.index =
+		{
+			.src = code->index.src,
+			.size = 0,
+			.lines = code->index.lines,
+			.count = 1,
+		},
+		.syntax =
+		{
+			.config = NULL,
+			.state = code->syntax.state,
+		},
 		.altFont = getConfig()->theme.code.altFont,
 		.event = onStudioEvent,
 		.update = update,
 	};
 
 	code->history = history_create(code->src, sizeof(tic_code));
-	code->cursorHistory = history_create(&code->cursor, sizeof code->cursor);
+	history_budget(code->history, getConfig()->undoBudget);
+
+	// the history starts from this text, so building the index records nothing
+	updateText(code, false, false);
+	updateEditor(code);
+}
+
+void freeCode(Code* code)
+{
+	if(code->history) history_delete(code->history);
 
-	update(code);
+	free(code->outline.items);
+	free(code->index.src);
+	free(code->index.lines);
+	free(code->syntax.state);
+	free(code);
 }
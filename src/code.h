@@ -62,12 +62,30 @@ struct Code
 
 	u8 colorBuffer[TIC_CODE_SIZE];
 
+	// copy of the text the line index and colors were built for
+	struct
+	{
+		char* src;
+		s32 size;
+
+		s32* lines;
+		s32 count;
+	} index;
+
+	struct
+	{
+		const tic_script_config* config;
+		tic_code_theme theme;
+
+		// lexer state at every line start
+		u8* state;
+	} syntax;
+
 	char status[STUDIO_TEXT_BUFFER_WIDTH+1];
 
 	u32 tickCounter;
 
 	struct History* history;
-	struct History* cursorHistory;
 
 	enum
 	{
@@ -107,3 +125,4 @@ struct Code
 };
 
 void initCode(Code*, tic_mem*, tic_code* src);
+void freeCode(Code*);
@@ -46,6 +46,62 @@ static void readConfigVideoScale(Config* config, lua_State* lua)
 	lua_pop(lua, 1);
 }
 
+static void readConfigPMemInterval(Config* config, lua_State* lua)
+{
+	lua_getglobal(lua, "PMEM_SYNC_INTERVAL");
+
+	if(lua_isinteger(lua, -1))
+		config->data.pmemInterval = (s32)lua_tointeger(lua, -1);
+
+	lua_pop(lua, 1);
+}
+
+static void readConfigUndoBudget(Config* config, lua_State* lua)
+{
+	lua_getglobal(lua, "UNDO_BUDGET");
+
+	if(lua_isinteger(lua, -1))
+		config->data.undoBudget = (s32)lua_tointeger(lua, -1);
+
+	lua_pop(lua, 1);
+}
+
+static void readConfigIdle(Config* config, lua_State* lua)
+{
+	lua_getglobal(lua, "IDLE_DELAY");
+
+	if(lua_isinteger(lua, -1))
+		config->data.idleDelay = (s32)lua_tointeger(lua, -1);
+
+	lua_pop(lua, 1);
+
+	lua_getglobal(lua, "IDLE_RATE");
+
+	if(lua_isinteger(lua, -1))
+		config->data.idleRate = (s32)lua_tointeger(lua, -1);
+
+	lua_pop(lua, 1);
+}
+
+static void readConfigConsoleLog(Config* config, lua_State* lua)
+{
+	lua_getglobal(lua, "CONSOLE_LOG");
+
+	if(lua_isstring(lua, -1))
+		snprintf(config->data.consoleLog, sizeof config->data.consoleLog, "%s", lua_tostring(lua, -1));
+	else if(lua_isboolean(lua, -1) && !lua_toboolean(lua, -1))
+		memset(config->data.consoleLog, 0, sizeof config->data.consoleLog);
+
+	lua_pop(lua, 1);
+
+	lua_getglobal(lua, "CONSOLE_LOG_RATE");
+
+	if(lua_isinteger(lua, -1))
+		config->data.consoleLogRate = (s32)lua_tointeger(lua, -1);
+
+	lua_pop(lua, 1);
+}
+
 static void readConfigCheckNewVersion(Config* config, lua_State* lua)
 {
 	lua_getglobal(lua, "CHECK_NEW_VERSION");
@@ -263,6 +319,10 @@ static void readConfig(Config* config)
 		{
 			readConfigVideoLength(config, lua);
 			readConfigVideoScale(config, lua);
+			readConfigPMemInterval(config, lua);
+			readConfigUndoBudget(config, lua);
+			readConfigIdle(config, lua);
+			readConfigConsoleLog(config, lua);
 			readConfigCheckNewVersion(config, lua);
 			readConfigNoSound(config, lua);
 			readConfigShowSync(config, lua);
@@ -289,6 +349,12 @@ static void setDefault(Config* config)
 	memset(&config->data, 0, sizeof(StudioConfig));
 
 	config->data.cart = &config->cart;
+	config->data.pmemInterval = PMEM_SYNC_INTERVAL;
+	config->data.undoBudget = UNDO_BUDGET;
+	config->data.idleDelay = IDLE_DELAY;
+	config->data.idleRate = IDLE_RATE;
+	config->data.consoleLogRate = CONSOLE_LOG_RATE;
+	strcpy(config->data.consoleLog, CONSOLE_LOG);
 
 	{
 		static const u8 DefaultBiosZip[] = 
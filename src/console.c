@@ -23,13 +23,16 @@
 #include "console.h"
 #include "fs.h"
 #include "config.h"
+#include "project.h"
 #include "ext/gif.h"
 #include "ext/file_dialog.h"
+#include "tracing.h"
 
 #include <zlib.h>
 #include <ctype.h>
 #include <string.h>
 #include <stddef.h>
+#include <time.h>
 
 #include <lua.h>
 #include <lauxlib.h>
@@ -48,7 +51,8 @@
 #define CONSOLE_BUFFER_WIDTH (STUDIO_TEXT_BUFFER_WIDTH)
 #define CONSOLE_BUFFER_HEIGHT (STUDIO_TEXT_BUFFER_HEIGHT)
 #define CONSOLE_BUFFER_SCREENS 64
-#define CONSOLE_BUFFER_SIZE (CONSOLE_BUFFER_WIDTH * CONSOLE_BUFFER_HEIGHT * CONSOLE_BUFFER_SCREENS)
+#define CONSOLE_BUFFER_ROWS (CONSOLE_BUFFER_HEIGHT * CONSOLE_BUFFER_SCREENS)
+#define CONSOLE_BUFFER_SIZE (CONSOLE_BUFFER_WIDTH * CONSOLE_BUFFER_ROWS)
 
 typedef enum
 {
@@ -87,8 +91,11 @@ typedef enum
 #if defined(CAN_EXPORT)
 
 static const char TicCartSig[] = "TIC.CART";
+static const char TicFooterSig[] = "TIC.FOOT";
 #define SIG_SIZE (sizeof TicCartSig-1)
 
+STATIC_ASSERT(footer_sig, sizeof TicFooterSig == sizeof TicCartSig);
+
 typedef struct
 {
 	u8 sig[SIG_SIZE];
@@ -96,6 +103,15 @@ typedef struct
 	s32 cartSize;
 } EmbedHeader;
 
+// written at the very end of the binary, so the cart can be found without scanning
+typedef struct
+{
+	s32 cartOffset;
+	s32 cartSize;
+	u32 checksum;
+	u8 sig[SIG_SIZE];
+} EmbedFooter;
+
 #endif
 
 #if defined(__TIC_WINDOWS__)
@@ -147,19 +163,21 @@ static const char* getCartName(const char* name)
 	return getName(name, CART_EXT);
 }
 
-static void scrollBuffer(char* buffer)
+static s32 getLineOffset(Console* console, s32 y)
 {
-	memmove(buffer, buffer + CONSOLE_BUFFER_WIDTH, CONSOLE_BUFFER_SIZE - CONSOLE_BUFFER_WIDTH);
-	memset(buffer + CONSOLE_BUFFER_SIZE - CONSOLE_BUFFER_WIDTH, 0, CONSOLE_BUFFER_WIDTH);
+	return (console->bufferTop + y) % CONSOLE_BUFFER_ROWS * CONSOLE_BUFFER_WIDTH;
 }
 
 static void scrollConsole(Console* console)
 {
-	while(console->cursor.y >= CONSOLE_BUFFER_HEIGHT * CONSOLE_BUFFER_SCREENS)
+	while(console->cursor.y >= CONSOLE_BUFFER_ROWS)
 	{
-		scrollBuffer(console->buffer);
-		scrollBuffer((char*)console->colorBuffer);
+		// the oldest line is reused as the new last one
+		s32 offset = getLineOffset(console, 0);
+		memset(console->buffer + offset, 0, CONSOLE_BUFFER_WIDTH);
+		memset(console->colorBuffer + offset, 0, CONSOLE_BUFFER_WIDTH);
 
+		console->bufferTop = (console->bufferTop + 1) % CONSOLE_BUFFER_ROWS;
 		console->cursor.y--;
 	}
 
@@ -168,42 +186,103 @@ static void scrollConsole(Console* console)
 		console->scroll.pos = minScroll;
 }
 
-static void consolePrint(Console* console, const char* text, u8 color)
+static FILE* getConsoleLog(Console* console)
+{
+	const char* path = getConfig()->consoleLog;
+
+	if(strcmp(console->log.path, path))
+	{
+		if(console->log.file && console->log.file != stdout)
+			fclose(console->log.file);
+
+		strcpy(console->log.path, path);
+
+		console->log.file = strcmp(path, "stdout") == 0 
+			? stdout 
+			: strlen(path) ? fopen(path, "a") : NULL;
+	}
+
+	return console->log.file;
+}
+
+static void logConsole(Console* console, const char* text)
 {
-	printf("%s", text);
+	FILE* file = getConsoleLog(console);
 
-	const char* textPointer = text;
-	const char* endText = textPointer + strlen(text);
+	if(!file) return;
 
-	while(textPointer != endText)
+	s32 rate = getConfig()->consoleLogRate;
+
+	if(rate > 0)
 	{
-		char symbol = *textPointer++;
+		s32 lines = 0;
+
+		for(const char* ptr = text; *ptr; ptr++)
+			if(*ptr == '\n') lines++;
 
-		scrollConsole(console);
+		s64 now = time(NULL);
 
-		if(symbol == '\n')
+		if(console->log.window != now)
 		{
-			console->cursor.x = 0;
-			console->cursor.y++;
+			if(console->log.skipped)
+				fprintf(file, "\n(%i lines skipped)\n", console->log.skipped);
+
+			console->log.window = now;
+			console->log.lines = 0;
+			console->log.skipped = 0;
 		}
-		else
+
+		if(console->log.lines >= rate)
 		{
-			s32 offset = console->cursor.x + console->cursor.y * CONSOLE_BUFFER_WIDTH;
-			*(console->buffer + offset) = symbol;
-			*(console->colorBuffer + offset) = color;
+			console->log.skipped += lines;
+			return;
+		}
 
-			console->cursor.x++;
+		console->log.lines += lines;
+	}
 
-			if(console->cursor.x >= CONSOLE_BUFFER_WIDTH)
-			{
-				console->cursor.x = 0;
-				console->cursor.y++;
-			}
-		}
+	fputs(text, file);
+}
+
+static void putSymbol(Console* console, char symbol, u8 color)
+{
+	scrollConsole(console);
 
+	if(symbol == '\n')
+	{
+		console->cursor.x = 0;
+		console->cursor.y++;
+	}
+	else
+	{
+		s32 offset = getLineOffset(console, console->cursor.y) + console->cursor.x;
+		*(console->buffer + offset) = symbol;
+		*(console->colorBuffer + offset) = color;
+
+		console->cursor.x++;
+
+		if(console->cursor.x >= CONSOLE_BUFFER_WIDTH)
+		{
+			console->cursor.x = 0;
+			console->cursor.y++;
+		}
 	}
 }
 
+static void putText(Console* console, const char* text, u8 color)
+{
+	console->prompt = false;
+
+	for(const char* ptr = text; *ptr; ptr++)
+		putSymbol(console, *ptr, color);
+}
+
+static void consolePrint(Console* console, const char* text, u8 color)
+{
+	logConsole(console, text);
+	putText(console, text, color);
+}
+
 static void printBack(Console* console, const char* text)
 {
 	consolePrint(console, text, CONSOLE_BACK_TEXT_COLOR);
@@ -235,6 +314,39 @@ static void commandDoneLine(Console* console, bool newLine)
 		printBack(console, dir);
 
 	printFront(console, ">");
+
+	console->prompt = true;
+}
+
+static void printAbovePrompt(Console* console, const char* text, u8 color)
+{
+	if(!console->prompt)
+	{
+		if(console->cursor.x)
+			printLine(console);
+
+		consolePrint(console, text, color);
+		return;
+	}
+
+	// the prompt row moves below the text, with what is being typed on it
+	char prompt[CONSOLE_BUFFER_WIDTH];
+	u8 colors[CONSOLE_BUFFER_WIDTH];
+	s32 size = console->cursor.x;
+	s32 offset = getLineOffset(console, console->cursor.y);
+
+	memcpy(prompt, console->buffer + offset, size);
+	memcpy(colors, console->colorBuffer + offset, size);
+	memset(console->buffer + offset, 0, size);
+	memset(console->colorBuffer + offset, 0, size);
+
+	console->cursor.x = 0;
+	consolePrint(console, text, color);
+
+	for(s32 i = 0; i < size; i++)
+		putSymbol(console, prompt[i], colors[i]);
+
+	console->prompt = true;
 }
 
 static void commandDone(Console* console)
@@ -254,26 +366,15 @@ static void drawCursor(Console* console, s32 x, s32 y, u8 symbol)
 
 static void drawConsoleText(Console* console)
 {
-	char* pointer = console->buffer + console->scroll.pos * CONSOLE_BUFFER_WIDTH;
-	u8* colorPointer = console->colorBuffer + console->scroll.pos * CONSOLE_BUFFER_WIDTH;
-
-	const char* end = console->buffer + CONSOLE_BUFFER_SIZE;
-	s32 x = 0;
-	s32 y = 0;
-
-	while(pointer < end)
+	for(s32 y = 0; y < CONSOLE_BUFFER_HEIGHT && console->scroll.pos + y < CONSOLE_BUFFER_ROWS; y++)
 	{
-		char symbol = *pointer++;
-		u8 color = *colorPointer++;
-
-		if(symbol)
-			console->tic->api.draw_char(console->tic, symbol, x * STUDIO_TEXT_WIDTH, y * STUDIO_TEXT_HEIGHT, color, false);
+		s32 offset = getLineOffset(console, console->scroll.pos + y);
+		const char* pointer = console->buffer + offset;
+		const u8* colorPointer = console->colorBuffer + offset;
 
-		if(++x == CONSOLE_BUFFER_WIDTH)
-		{
-			y++;
-			x = 0;
-		}
+		for(s32 x = 0; x < CONSOLE_BUFFER_WIDTH; x++)
+			if(pointer[x])
+				console->tic->api.draw_char(console->tic, pointer[x], x * STUDIO_TEXT_WIDTH, y * STUDIO_TEXT_HEIGHT, colorPointer[x], false);
 	}
 }
 
@@ -382,80 +483,107 @@ static bool loadRom(tic_mem* tic, const void* data, s32 size)
 	return true;
 }
 
-static bool onConsoleLoadSectionCommand(Console* console, const char* param)
+static const char* LoadSections[] =
 {
-	bool result = false;
+	"cover",
+	"sprites",
+	"map",
+	"code",
+	"sfx",
+	"music",
+	"palette",
+};
 
-	if(param)
+typedef struct
+{
+	Console* console;
+	char name[FILENAME_MAX];
+	s32 section;
+} LoadSectionData;
+
+static void onLoadSectionDone(const void* data, s32 size, void* calldata)
+{
+	LoadSectionData* loadSectionData = (LoadSectionData*)calldata;
+	Console* console = loadSectionData->console;
+	s32 i = loadSectionData->section;
+
+	if(data)
 	{
-		static const char* Sections[] =
+		tic_cartridge* cart = (tic_cartridge*)malloc(sizeof(tic_cartridge));
+
+		if(cart)
 		{
-			"cover",
-			"sprites",
-			"map",
-			"code",
-			"sfx",
-			"music",
-			"palette",
-		};
+			tic_mem* tic = console->tic;
+			tic->api.load(cart, data, size);
+
+			switch(i)
+			{
+			case 0: memcpy(&tic->cart.cover, 			&cart->cover, 			sizeof cart->cover); break;
+			case 1: memcpy(&tic->cart.bank0.tiles, 		&cart->bank0.tiles, 	sizeof(tic_tiles)*2); break;
+			case 2: memcpy(&tic->cart.bank0.map, 		&cart->bank0.map, 		sizeof(tic_map)); break;
+			case 3: memcpy(&tic->cart.code, 			&cart->code, 			sizeof(tic_code)); break;
+			case 4: memcpy(&tic->cart.bank0.sfx, 		&cart->bank0.sfx, 		sizeof(tic_sfx)); break;
+			case 5: memcpy(&tic->cart.bank0.music, 		&cart->bank0.music, 	sizeof(tic_music)); break;
+			case 6: memcpy(&tic->cart.bank0.palette, 	&cart->bank0.palette,	sizeof(tic_palette)); break;
+			}
+
+			studioRomLoaded();
+
+			printLine(console);
+			printFront(console, LoadSections[i]);
+			printBack(console, " loaded from ");
+			printFront(console, loadSectionData->name);
+			printLine(console);
+
+			free(cart);
+		}
+	}
+	else printBack(console, "\ncart loading error");
+
+	commandDone(console);
+
+	free(loadSectionData);
+}
 
+static bool onConsoleLoadSectionCommand(Console* console, const char* param)
+{
+	if(param)
+	{
 		char buf[64] = {0};
 
-		for(s32 i = 0; i < COUNT_OF(Sections); i++)
+		for(s32 i = 0; i < COUNT_OF(LoadSections); i++)
 		{
-			sprintf(buf, "%s %s", CART_EXT, Sections[i]);
+			sprintf(buf, "%s %s", CART_EXT, LoadSections[i]);
 			char* pos = strstr(param, buf);
 
 			if(pos)
 			{
 				pos[sizeof(CART_EXT) - 1] = 0;
 				const char* name = getCartName(param);
-				s32 size = 0;
-				void* data = fsLoadFile(console->fs, name, &size);
-
-				if(data)
-				{
-					tic_cartridge* cart = (tic_cartridge*)malloc(sizeof(tic_cartridge));
-
-					if(cart)
-					{
-						tic_mem* tic = console->tic;
-                        tic->api.load(cart, data, size);
 
-						switch(i)
-						{
-						case 0: memcpy(&tic->cart.cover, 			&cart->cover, 			sizeof cart->cover); break;
-						case 1: memcpy(&tic->cart.bank0.tiles, 		&cart->bank0.tiles, 	sizeof(tic_tiles)*2); break;
-						case 2: memcpy(&tic->cart.bank0.map, 		&cart->bank0.map, 		sizeof(tic_map)); break;
-						case 3: memcpy(&tic->cart.code, 			&cart->code, 			sizeof(tic_code)); break;
-						case 4: memcpy(&tic->cart.bank0.sfx, 		&cart->bank0.sfx, 		sizeof(tic_sfx)); break;
-						case 5: memcpy(&tic->cart.bank0.music, 		&cart->bank0.music, 	sizeof(tic_music)); break;
-						case 6: memcpy(&tic->cart.bank0.palette, 	&cart->bank0.palette,	sizeof(tic_palette)); break;
-						}
-
-						studioRomLoaded();
-
-						printLine(console);
-						printFront(console, Sections[i]);
-						printBack(console, " loaded from ");
-						printFront(console, name);
-						printLine(console);
+				LoadSectionData* loadSectionData = (LoadSectionData*)malloc(sizeof(LoadSectionData));
 
-						free(cart);
-
-						result = true;
-					}
+				if(loadSectionData && strlen(name) < FILENAME_MAX)
+				{
+					*loadSectionData = (LoadSectionData){console, {0}, i};
+					strcpy(loadSectionData->name, name);
 
-					free(data);
+					// public carts call back once they are downloaded
+					fsLoadFileAsync(console->fs, name, onLoadSectionDone, loadSectionData);
+				}
+				else
+				{
+					free(loadSectionData);
+					printBack(console, "\ncart loading error");
+					commandDone(console);
 				}
-				else printBack(console, "\ncart loading error");
 
-				commandDone(console);
+				return true;
 			}
 		}
 	}
 
-	return result;
+	return false;
 }
 
 static void* getDemoCart(Console* console, ScriptLang script, s32* size)
@@ -691,347 +819,124 @@ static const char* projectComment(const char* name)
 	return comment;
 }
 
-static void buf2str(const void* data, s32 size, char* ptr, bool flip)
-{
-	enum {Len = 2};
-
-	for(s32 i = 0; i < size; i++, ptr+=Len)
-	{
-		sprintf(ptr, "%02x", ((u8*)data)[i]);
-
-		if(flip)
-		{
-			char tmp = ptr[0];
-			ptr[0] = ptr[1];
-			ptr[1] = tmp;
-		}
-	}
-}
-
-static bool bufferEmpty(const u8* data, s32 size)
-{
-	for(s32 i = 0; i < size; i++)
-		if(*data++)
-			return false;
-
-	return true;
-}
-
-static char* saveTextSection(char* ptr, const char* data)
-{
-	if(strlen(data) == 0)
-		return ptr;
-
-	sprintf(ptr, "%s\n", data);
-	ptr += strlen(ptr);
-
-	return ptr;
-}
-
-static char* saveTextSectionBank(char* ptr, const char* comment, const char* tag, const char* data)
-{
-	if(strlen(data) == 0)
-		return ptr;
-
-	sprintf(ptr, "%s <%s>\n", comment, tag);
-	ptr += strlen(ptr);
-
-	ptr = saveTextSection(ptr, data);
-
-	sprintf(ptr, "%s </%s>\n\n", comment, tag);
-	ptr += strlen(ptr);
-
-	return ptr;
-}
-
-static char* saveBinaryBuffer(char* ptr, const char* comment, const void* data, s32 size, s32 row, bool flip)
-{
-	if(bufferEmpty(data, size)) 
-		return ptr;
-
-	sprintf(ptr, "%s %03i:", comment, row);
-	ptr += strlen(ptr);
-
-	buf2str(data, size, ptr, flip);
-	ptr += strlen(ptr);
-
-	sprintf(ptr, "\n");
-	ptr += strlen(ptr);
-
-	return ptr;
-}
-
-static char* saveBinarySection(char* ptr, const char* comment, const char* tag, s32 count, const void* data, s32 size, bool flip)
-{
-	if(bufferEmpty(data, size * count)) 
-		return ptr;
-
-	sprintf(ptr, "%s <%s>\n", comment, tag);
-	ptr += strlen(ptr);
-
-	for(s32 i = 0; i < count; i++, data = (u8*)data + size)
-		ptr = saveBinaryBuffer(ptr, comment, data, size, i, flip);
-
-	sprintf(ptr, "%s </%s>\n\n", comment, tag);
-	ptr += strlen(ptr);
-
-	return ptr;
-}
-
-typedef struct {char* tag; s32 count; s32 offset; s32 size; bool flip;} BinarySection;
-static const BinarySection BinarySections[] = 
-{
-	{"TILES", 		TIC_BANK_SPRITES, 	offsetof(tic_bank, tiles), 			sizeof(tic_tile), 			true},
-	{"SPRITES", 	TIC_BANK_SPRITES, 	offsetof(tic_bank, sprites), 		sizeof(tic_tile), 			true},
-	{"MAP", 		TIC_MAP_HEIGHT, 	offsetof(tic_bank, map), 			TIC_MAP_WIDTH, 				true},
-	{"WAVES", 		WAVES_COUNT, 		offsetof(tic_bank, sfx.waveform), 	sizeof(tic_waveform), 		true},
-	{"SFX", 		SFX_COUNT, 			offsetof(tic_bank, sfx.samples), 	sizeof(tic_sample), 		true},
-	{"PATTERNS", 	MUSIC_PATTERNS, 	offsetof(tic_bank, music.patterns), sizeof(tic_track_pattern), 	true},
-	{"TRACKS", 		MUSIC_TRACKS, 		offsetof(tic_bank, music.tracks), 	sizeof(tic_track), 			true},
-	{"FLAGS", 		TIC_SPRITE_BANKS, 	offsetof(tic_bank, flags), 			TIC_BANK_SPRITES, 			true},
-	{"PALETTE", 	1, 					offsetof(tic_bank, palette), 		sizeof(tic_palette), 		false},
-};
-
-static void makeTag(const char* tag, char* out, s32 bank)
-{
-	if(bank) sprintf(out, "%s%i", tag, bank);
-	else strcpy(out, tag);
-}
-
 static s32 saveProject(Console* console, void* buffer, const char* comment)
 {
-	tic_mem* tic = console->tic;
-
-	char* stream = buffer;
-	char* ptr = saveTextSection(stream, tic->cart.code.data);
-	char tag[16];
-
-	for(s32 i = 0; i < COUNT_OF(BinarySections); i++)
-	{
-		const BinarySection* section = &BinarySections[i];
-
-		for(s32 b = 0; b < TIC_BANKS; b++)
-		{
-			makeTag(section->tag, tag, b);
-
-			ptr = saveBinarySection(ptr, comment, tag, section->count, 
-				(u8*)&tic->cart.banks[b] + section->offset, section->size, section->flip);
-		}
-	}		
-
-	ptr = saveBinarySection(ptr, comment, "COVER", 1, &tic->cart.cover, tic->cart.cover.size + sizeof(s32), true);
-
-	return strlen(stream);
+	return tic_project_save(comment, buffer, &console->tic->cart);
 }
 
-static bool loadTextSection(const char* project, const char* comment, char* dst, s32 size)
+static bool loadProject(Console* console, const char* name, const char* data, s32 size, tic_cartridge* dst)
 {
-	bool done = false;
-
-	const char* start = project;
-	const char* end = project + strlen(project);
-
-	{
-		char tagstart[16];
-		sprintf(tagstart, "\n%s <", comment);
+	tic_cartridge* cart = (tic_cartridge*)malloc(sizeof(tic_cartridge));
 
-		const char* ptr = strstr(project, tagstart);
-
-		if(ptr && ptr < end)
-			end = ptr;
-	}
+	bool done = false;
 
-	if(end > start)
+	if(cart)
 	{
-		memcpy(dst, start, MIN(size, end - start));
-		done = true;
-	}
-
-	return done;
-}
-
-static inline const char* getLineEnd(const char* ptr)
-{
-	while(*ptr && isspace(*ptr) && *ptr++ != '\n');
-
-	return ptr;
-}
+		memset(cart, 0, sizeof(tic_cartridge));
 
-static bool loadTextSectionBank(const char* project, const char* comment, const char* tag, char* dst, s32 size)
-{
-	char tagbuf[64];
-	sprintf(tagbuf, "%s <%s>", comment, tag);
-
-	const char* start = strstr(project, tagbuf);
-	bool done = false;
+		// TODO: should we use DB16 default palette here?
+		memcpy(&cart->bank0.palette, &getConfig()->cart->bank0.palette.data, sizeof(tic_palette));
 
-	if(start)
-	{
-		start += strlen(tagbuf);
-		start = getLineEnd(start);
+		done = tic_project_load(projectComment(name), data, size, cart);
 
-		sprintf(tagbuf, "\n%s </%s>", comment, tag);
-		const char* end = strstr(start, tagbuf);
+		memcpy(dst, cart, sizeof(tic_cartridge));
 
-		if(end > start)
-		{
-			memcpy(dst, start, MIN(size, end - start));
-			
-			done = true;
-		}
+		free(cart);
 	}
 
 	return done;
 }
 
-static bool loadBinarySection(const char* project, const char* comment, const char* tag, s32 count, void* dst, s32 size, bool flip)
+static void updateProject(Console* console)
 {
-	char tagbuf[64];
-	sprintf(tagbuf, "%s <%s>", comment, tag);
-
-	const char* start = strstr(project, tagbuf);
-	bool done = false;
-
-	if(start)
+	if(strlen(console->romName) && hasProjectExt(console->romName))
 	{
-		start += strlen(tagbuf);
-		start = getLineEnd(start);
-
-		sprintf(tagbuf, "\n%s </%s>", comment, tag);
-		const char* end = strstr(start, tagbuf);
+		s32 size = 0;
+		void* data = fsLoadFile(console->fs, console->romName, &size);
 
-		if(end > start)
+		if(data)
 		{
-			const char* ptr = start;
-
-			if(size > 0)
-			{
-				while(ptr < end)
-				{
-					static char lineStr[] = "999";
-					memcpy(lineStr, ptr + sizeof("-- ") - 1, sizeof lineStr - 1);
-
-					s32 index = atoi(lineStr);
-					
-					if(index < count)
-					{
-						ptr += sizeof("-- 999:") - 1;
-						str2buf(ptr, size*2, (u8*)dst + size*index, flip);
-						ptr += size*2 + 1;
+			tic_cartridge* cart = malloc(sizeof(tic_cartridge));
 
-						ptr = getLineEnd(ptr);
-					}
-					else break;
-				}				
-			}
-			else
+			if(cart)
 			{
-				ptr += sizeof("-- 999:") - 1;
-				str2buf(ptr, end - ptr, (u8*)dst, flip);
+				if(loadProject(console, console->romName, data, size, cart))
+					studioRomReloaded(cart);
+				
+				free(cart);
 			}
+			free(data);
 
-			done = true;
-		}
+		}		
 	}
-
-	return done;
 }
 
-static bool loadProject(Console* console, const char* name, const char* data, s32 size, tic_cartridge* dst)
+#endif
+
+typedef struct
 {
-	char* project = (char*)malloc(size+1);
+	Console* console;
+	char name[FILENAME_MAX];
+	void(*done)(bool loaded, void* data);
+	void* data;
+} LoadCartData;
 
-	bool done = false;
+static void onLoadCartDone(const void* data, s32 size, void* calldata)
+{
+	LoadCartData* loadCartData = (LoadCartData*)calldata;
+	Console* console = loadCartData->console;
 
-	if(project)
+	if(data)
 	{
-		memcpy(project, data, size);
-		project[size] = '\0';
-
-		// remove all the '\r' chars
-		{
-			char *s, *d;
-			for(s = d = project; (*d = *s); d += (*s++ != '\r'));
-		}
-
-		tic_cartridge* cart = (tic_cartridge*)malloc(sizeof(tic_cartridge));
-
-		if(cart)
-		{
-			memset(cart, 0, sizeof(tic_cartridge));
-
-			// TODO: should we use DB16 default palette here?
-            memcpy(&cart->bank0.palette, &getConfig()->cart->bank0.palette.data, sizeof(tic_palette));
-
-			const char* comment = projectComment(name);
-			char tag[16];
-
-			if(loadTextSection(project, comment, cart->code.data, sizeof(tic_code)))
-				done = true;
-
-			for(s32 i = 0; i < COUNT_OF(BinarySections); i++)
-			{
-				const BinarySection* section = &BinarySections[i];
-
-				for(s32 b = 0; b < TIC_BANKS; b++)
-				{
-					makeTag(section->tag, tag, b);
-
-					if(loadBinarySection(project, comment, tag, section->count, (u8*)&cart->banks[b] + section->offset, section->size, section->flip))
-						done = true;
-				}
-			}
+		console->showGameMenu = true;
 
-			if(loadBinarySection(project, comment, "COVER", 1, &cart->cover, -1, true))
-				done = true;
-			
-			memcpy(dst, cart, sizeof(tic_cartridge));
+		loadRom(console->tic, data, size);
+		onCartLoaded(console, loadCartData->name);
+	}
+	else printBack(console, "\ncart loading error");
 
-			free(cart);
-		}
+	commandDone(console);
 
-		free(project);
-	}
+	if(loadCartData->done)
+		loadCartData->done(data != NULL, loadCartData->data);
 
-	return done;
+	free(loadCartData);
 }
 
-static void updateProject(Console* console)
+static void loadPublicCart(Console* console, const char* name, const char* hash, void(*done)(bool loaded, void* data), void* data)
 {
-	tic_mem* tic = console->tic;
+	LoadCartData* loadCartData = (LoadCartData*)malloc(sizeof(LoadCartData));
 
-	if(strlen(console->romName) && hasProjectExt(console->romName))
+	if(loadCartData && strlen(name) < FILENAME_MAX)
 	{
-		s32 size = 0;
-		void* data = fsLoadFile(console->fs, console->romName, &size);
-
-		if(data)
-		{
-			tic_cartridge* cart = malloc(sizeof(tic_cartridge));
-
-			if(cart)
-			{
-				if(loadProject(console, console->romName, data, size, cart))
-				{
-					memcpy(&tic->cart, cart, sizeof(tic_cartridge));
+		*loadCartData = (LoadCartData){console, {0}, done, data};
+		strcpy(loadCartData->name, name);
 
-					studioRomLoaded();
-				}
-				
-				free(cart);
-			}
-			free(data);
+		if(hash)
+			fsLoadFileByHashAsync(console->fs, hash, onLoadCartDone, loadCartData);
+		else fsLoadFileAsync(console->fs, name, onLoadCartDone, loadCartData);
+	}
+	else
+	{
+		free(loadCartData);
+		printBack(console, "\ncart loading error");
+		commandDone(console);
 
-		}		
+		if(done)
+			done(false, data);
 	}
 }
 
-#endif
-
 static void onConsoleLoadCommandConfirmed(Console* console, const char* param)
 {
 	if(onConsoleLoadSectionCommand(console, param)) return;
 
+	if(param && fsIsInPublicDir(console->fs))
+	{
+		loadPublicCart(console, getCartName(param), NULL, NULL, NULL);
+		return;
+	}
+
 	if(param)
 	{
 		s32 size = 0;
@@ -1043,7 +948,7 @@ static void onConsoleLoadCommandConfirmed(Console* console, const char* param)
 
 		if(data)
 		{
-			console->showGameMenu = fsIsInPublicDir(console->fs);
+			console->showGameMenu = false;
 
 			loadRom(console->tic, data, size);
 
@@ -1094,28 +999,17 @@ static void onConsoleLoadCommandConfirmed(Console* console, const char* param)
 	commandDone(console);
 }
 
-static void load(Console* console, const char* path, const char* hash)
+static void load(Console* console, const char* path, const char* hash, void(*done)(bool loaded, void* data), void* data)
 {
 	if(hash)
+		loadPublicCart(console, getCartName(path), hash, done, data);
+	else
 	{
-		s32 size = 0;
-		const char* name = getCartName(path);
-
-		void* data = fsLoadFileByHash(console->fs, hash, &size);
-
-		if(data)
-		{
-			console->showGameMenu = true;
-
-			loadRom(console->tic, data, size);
-			onCartLoaded(console, name);
-
-			free(data);		
-		}
+		onConsoleLoadCommandConfirmed(console, path);
 
-		commandDone(console);
+		if(done)
+			done(true, data);
 	}
-	else onConsoleLoadCommandConfirmed(console, path);
 }
 
 typedef void(*ConfirmCallback)(Console* console, const char* param);
@@ -1340,6 +1234,16 @@ static bool printFilename(const char* name, const char* info, s32 id, void* data
 	return true;
 }
 
+static void onChangeDirectoryDone(bool dir, void* data)
+{
+	Console* console = (Console*)data;
+
+	if(!dir)
+		printBack(console, "\ndir doesn't exist");
+
+	commandDone(console);
+}
+
 static void onConsoleChangeDirectory(Console* console, const char* param)
 {
 	if(param && strlen(param))
@@ -1352,11 +1256,11 @@ static void onConsoleChangeDirectory(Console* console, const char* param)
 		{
 			fsDirBack(console->fs);
 		}
-		else if(fsIsDir(console->fs, param))
+		else
 		{
-			fsChangeDir(console->fs, param);
+			fsChangeDirAsync(console->fs, param, onChangeDirectoryDone, console);
+			return;
 		}
-		else printBack(console, "\ndir doesn't exist");
 	}
 	else printBack(console, "\ninvalid dir name");
 
@@ -1372,15 +1276,12 @@ static void onConsoleMakeDirectory(Console* console, const char* param)
 	commandDone(console);
 }
 
-static void onConsoleDirCommand(Console* console, const char* param)
+static void onDirDone(void* data)
 {
-	PrintFileNameData data = {0, console};
-
-	printLine(console);
-
-	fsEnumFiles(console->fs, printFilename, &data);
+	PrintFileNameData* printData = data;
+	Console* console = printData->console;
 
-	if(data.count == 0)
+	if(printData->count == 0)
 	{
 		printBack(console, "\n\nuse ");
 		printFront(console, "ADD");
@@ -1391,6 +1292,24 @@ static void onConsoleDirCommand(Console* console, const char* param)
 
 	printLine(console);
 	commandDone(console);
+
+	free(printData);
+}
+
+static void onConsoleDirCommand(Console* console, const char* param)
+{
+	PrintFileNameData* data = malloc(sizeof(PrintFileNameData));
+
+	if(data)
+	{
+		*data = (PrintFileNameData){0, console};
+
+		printLine(console);
+
+		// public folders are listed once the request is done
+		fsEnumFilesAsync(console->fs, printFilename, onDirDone, data);
+	}
+	else commandDone(console);
 }
 
 #if defined(CAN_EXPORT)
@@ -1408,6 +1327,7 @@ static void onConsoleClsCommand(Console* console, const char* param)
 {
 	memset(console->buffer, 0, CONSOLE_BUFFER_SIZE);
 	memset(console->colorBuffer, TIC_COLOR_BG, CONSOLE_BUFFER_SIZE);
+	console->bufferTop = 0;
 	console->scroll.pos = 0;
 	console->cursor.x = console->cursor.y = 0;
 
@@ -1516,6 +1436,39 @@ static void onConsoleVersionCommand(Console* console, const char* param)
 	commandDone(console);
 }
 
+#if defined(TIC80_TRACING)
+
+static bool startTracing(const char* path)
+{
+	return tracing_start(path, getSystem()->getPerformanceCounter, getSystem()->getPerformanceFrequency);
+}
+
+static void onConsoleTraceCommand(Console* console, const char* param)
+{
+	if(param)
+	{
+		char path[FILENAME_MAX];
+		fsGetRootFilePath(console->fs, param, path);
+
+		if(startTracing(path))
+		{
+			printBack(console, "\ntracing to ");
+			printFront(console, path);
+		}
+		else printError(console, "\ncannot open trace file :(");
+	}
+	else if(tracing_active())
+	{
+		tracing_stop();
+		printBack(console, "\ntrace saved :)");
+	}
+	else printBack(console, "\nusage: trace <file> to start, trace to stop");
+
+	commandDone(console);
+}
+
+#endif
+
 static void onConsoleConfigCommand(Console* console, const char* param)
 {
 	if(param == NULL)
@@ -1679,6 +1632,7 @@ static void onImportSprites(const char* name, const void* buffer, size_t size, v
 					}
 
 				gif_close(image);
+				studioCartTouched();
 
 				printLine(console);
 				printBack(console, name);
@@ -1699,6 +1653,7 @@ static void injectMap(Console* console, const void* buffer, s32 size)
 
 	memset(getBankMap(), 0, Size);
 	memcpy(getBankMap(), buffer, MIN(size, Size));
+	studioCartTouched();
 }
 
 static void onImportMap(const char* name, const void* buffer, size_t size, void* data)
@@ -1925,7 +1880,16 @@ static void* embedCart(Console* console, s32* size)
 
 						memcpy(header.sig, TicCartSig, SIG_SIZE);
 
-						s32 finalSize = appSize + sizeof header + header.cartSize;
+						EmbedFooter footer = 
+						{
+							.cartOffset = appSize + sizeof header,
+							.cartSize = zipSize,
+							.checksum = adler32(adler32(0, NULL, 0), zip, zipSize),
+						};
+
+						memcpy(footer.sig, TicFooterSig, SIG_SIZE);
+
+						s32 finalSize = appSize + sizeof header + header.cartSize + sizeof footer;
 						data = malloc(finalSize);
 
 						if(data)
@@ -1933,6 +1897,7 @@ static void* embedCart(Console* console, s32* size)
 							memcpy(data, app, appSize);
 							memcpy(data + appSize, &header, sizeof header);
 							memcpy(data + appSize + sizeof header, zip, header.cartSize);
+							memcpy(data + appSize + sizeof header + header.cartSize, &footer, sizeof footer);
 
 							*size = finalSize;
 						}
@@ -1951,6 +1916,38 @@ static void* embedCart(Console* console, s32* size)
 	return data;
 }
 
+static void loadEmbedFooter(Console* console)
+{
+	EmbedFooter footer;
+
+	if(!fsReadFileRange(console->appPath, -(s32)sizeof footer, &footer, sizeof footer)
+		|| memcmp(footer.sig, TicFooterSig, SIG_SIZE) != 0
+		|| footer.cartSize <= 0 || (size_t)footer.cartSize > sizeof(tic_cartridge))
+		return;
+
+	u8* zip = malloc(footer.cartSize);
+
+	if(zip)
+	{
+		if(fsReadFileRange(console->appPath, footer.cartOffset, zip, footer.cartSize)
+			&& adler32(adler32(0, NULL, 0), zip, footer.cartSize) == footer.checksum)
+		{
+			u8* data = NULL;
+			s32 dataSize = unzip(&data, zip, footer.cartSize);
+
+			if(data)
+			{
+				console->tic->api.load(console->embed.file, data, dataSize);
+				console->embed.yes = true;
+
+				free(data);
+			}
+		}
+
+		free(zip);
+	}
+}
+
 static void onConsoleExportNativeCommand(Console* console, const char* cartName)
 {
 	s32 size = 0;
@@ -2244,51 +2241,20 @@ static void onConsoleDelCommand(Console* console, const char* param)
 
 static void printTable(Console* console, const char* text)
 {
-	printf("%s", text);
-
-	const char* textPointer = text;
-	const char* endText = textPointer + strlen(text);
+	logConsole(console, text);
 
-	while(textPointer != endText)
+	for(const char* ptr = text; *ptr; ptr++)
 	{
-		char symbol = *textPointer++;
-
-		scrollConsole(console);
-
-		if(symbol == '\n')
-		{
-			console->cursor.x = 0;
-			console->cursor.y++;
-		}
-		else
+		switch(*ptr)
 		{
-			s32 offset = console->cursor.x + console->cursor.y * CONSOLE_BUFFER_WIDTH;
-			*(console->buffer + offset) = symbol;
-
-			u8 color = 0;
-
-			switch(symbol)
-			{
-			case '+':
-			case '|':
-			case '-':
-				color = CONSOLE_BACK_TEXT_COLOR;
-				break;
-			default:
-				color = CONSOLE_FRONT_TEXT_COLOR;
-			}
-
-			*(console->colorBuffer + offset) = color;
-
-			console->cursor.x++;
-
-			if(console->cursor.x >= CONSOLE_BUFFER_WIDTH)
-			{
-				console->cursor.x = 0;
-				console->cursor.y++;
-			}
+		case '+':
+		case '|':
+		case '-':
+			putSymbol(console, *ptr, CONSOLE_BACK_TEXT_COLOR);
+			break;
+		default:
+			putSymbol(console, *ptr, CONSOLE_FRONT_TEXT_COLOR);
 		}
-
 	}
 }
 
@@ -2370,6 +2336,121 @@ static void onConsoleVRamCommand(Console* console, const char* param)
 	commandDone(console);
 }
 
+#define PROFILE_PERIOD 1000
+#define PROFILE_TOP 8
+
+// indices of the biggest hits in descending order
+static s32 getProfileTop(const u32* hits, s32 count, s32* top, s32 size)
+{
+	s32 found = 0;
+
+	for(s32 i = 0; i < count; i++)
+	{
+		if(!hits[i]) continue;
+
+		s32 j = MIN(found, size - 1);
+
+		if(found == size && hits[top[j]] >= hits[i]) continue;
+		if(found < size) found++;
+
+		for(; j > 0 && hits[top[j-1]] < hits[i]; j--)
+			top[j] = top[j-1];
+
+		top[j] = i;
+	}
+
+	return found;
+}
+
+static const char* getCodeLine(const char* code, s32 line)
+{
+	for(; line && *code; code++)
+		if(*code == '\n') line--;
+
+	while(*code == ' ' || *code == '\t') code++;
+
+	return code;
+}
+
+static void getFunctionName(Console* console, s32 line, char* name, s32 size)
+{
+	const char* code = console->tic->cart.code.data;
+	const tic_script_config* config = console->tic->api.get_script_config(console->tic);
+
+	strcpy(name, "(anonymous)");
+
+	if(config->getOutline)
+	{
+		s32 count = 0;
+		const tic_outline_item* items = config->getOutline(code, &count);
+
+		s32 start = (s32)(getCodeLine(code, line) - code);
+		s32 end = start + (s32)strcspn(code + start, "\n");
+
+		for(s32 i = 0; i < count; i++)
+			if(items[i].pos >= start && items[i].pos < end)
+			{
+				snprintf(name, size, "%.*s", items[i].size, code + items[i].pos);
+				break;
+			}
+	}
+}
+
+static void printProfileTable(Console* console, const tic_profile* profile, const u32* hits, const char* title)
+{
+	char buf[STUDIO_TEXT_BUFFER_WIDTH];
+	char info[18];
+
+	printTable(console, "\n+-------+-------------------+-------+");
+	sprintf(buf, "\n| LINE  | %-17s |   %%   |", title);
+	printTable(console, buf);
+	printTable(console, "\n+-------+-------------------+-------+");
+
+	s32 top[PROFILE_TOP];
+	s32 count = getProfileTop(hits, COUNT_OF(profile->lines), top, COUNT_OF(top));
+
+	for(s32 i = 0; i < count; i++)
+	{
+		if(hits == profile->functions)
+			getFunctionName(console, top[i], info, sizeof info);
+		else
+		{
+			const char* line = getCodeLine(console->tic->cart.code.data, top[i]);
+			snprintf(info, sizeof info, "%.*s", (s32)strcspn(line, "\n"), line);
+		}
+
+		sprintf(buf, "\n| %-5i | %-17s | %5.1f |", top[i] + 1, info, hits[top[i]] * 100.0 / profile->samples);
+		printTable(console, buf);
+	}
+
+	printTable(console, "\n+-------+-------------------+-------+");
+}
+
+static void onConsoleProfileCommand(Console* console, const char* param)
+{
+	if(param && strcmp(param, "on") == 0)
+	{
+		setProfilePeriod(PROFILE_PERIOD);
+		printBack(console, "\nprofiling the next run...");
+	}
+	else if(param && strcmp(param, "off") == 0)
+	{
+		setProfilePeriod(0);
+		printBack(console, "\nprofiling is off");
+	}
+	else if(getProfile())
+	{
+		const tic_profile* profile = getProfile();
+
+		printLine(console);
+		printProfileTable(console, profile, profile->functions, "FUNCTION");
+		printProfileTable(console, profile, profile->lines, "CODE");
+	}
+	else printBack(console, "\nno samples, use 'profile on' and run the cart");
+
+	commandDone(console);
+}
+
 static const struct
 {
 	const char* command;
@@ -2409,6 +2490,10 @@ static const struct
 	{"version",	NULL, "show the current version",	onConsoleVersionCommand},
 	{"edit",	NULL, "open cart editor",			onConsoleCodeCommand},
 	{"surf",	NULL, "open carts browser",			onConsoleSurfCommand},
+	{"profile",	NULL, "show script hot spots",		onConsoleProfileCommand},
+#if defined(TIC80_TRACING)
+	{"trace",	NULL, "trace frame phases to file",	onConsoleTraceCommand},
+#endif
 };
 
 static bool predictFilename(const char* name, const char* info, s32 id, void* data, bool dir)
@@ -2640,16 +2725,63 @@ static void processConsoleCommand(Console* console)
 	else commandDone(console);
 }
 
+static void flush(Console* console)
+{
+	if(console->traces.size)
+	{
+		const char* end = console->traces.data + console->traces.size;
+
+		// already logged by trace()
+		for(const char* ptr = console->traces.data; ptr < end; ptr += strlen(ptr + 1) + 2)
+		{
+			putText(console, ptr + 1, *ptr);
+			putText(console, "\n", 0);
+		}
+
+		console->traces.size = 0;
+		commandDoneLine(console, false);
+	}
+
+	if(console->log.file)
+		fflush(console->log.file);
+}
+
 static void error(Console* console, const char* info)
 {
+	flush(console);
+
 	consolePrint(console, info ? info : "unknown error", CONSOLE_ERROR_TEXT_COLOR);
 	commandDone(console);
 }
 
+// traces are logged right away, for the screen they are queued as a color byte
+// followed by the text and printed once per frame
 static void trace(Console* console, const char* text, u8 color)
 {
-	consolePrint(console, text, color);
-	commandDone(console);
+	logConsole(console, text);
+	logConsole(console, "\n");
+
+	s32 size = (s32)strlen(text) + 2;
+
+	if(console->traces.size + size > console->traces.capacity)
+	{
+		s32 capacity = MAX(console->traces.capacity * 2, console->traces.size + size);
+		char* data = realloc(console->traces.data, capacity);
+
+		if(!data) return;
+
+		console->traces.data = data;
+		console->traces.capacity = capacity;
+	}
+
+	char* ptr = console->traces.data + console->traces.size;
+	*ptr = color;
+	memcpy(ptr + 1, text, size - 1);
+	console->traces.size += size;
+
+	// a frame can't show more than the whole buffer anyway
+	if(console->traces.size > CONSOLE_BUFFER_SIZE)
+		flush(console);
 }
 
 static void setScroll(Console* console, s32 val)
@@ -2692,8 +2824,10 @@ static lua_State* netLuaInit(u8* buffer, s32 size)
 	return NULL;
 }
 
-static NetVersion netVersionRequest()
+static void onVersionLoaded(const HttpGetData* data)
 {
+	Console* console = (Console*)data->calldata;
+
 	NetVersion version = 
 	{
 		.major = TIC_VERSION_MAJOR,
@@ -2701,13 +2835,9 @@ static NetVersion netVersionRequest()
 		.patch = TIC_VERSION_REVISION,
 	};
 
-	s32 size = 0;
-	void* buffer = getSystem()->getUrlRequest("/api?fn=version", &size);
-
-	if(buffer && size)
+	if(data->status == HttpGetDone && data->size)
 	{
-		lua_State* lua = netLuaInit(buffer, size);
-		free(buffer);
+		lua_State* lua = netLuaInit((u8*)data->data, data->size);
 
 		if(lua)
 		{
@@ -2727,28 +2857,27 @@ static NetVersion netVersionRequest()
 		}
 	}
 
-	return version;
-}
-
-static void checkNewVersion(Console* console)
-{
-
-	NetVersion version = netVersionRequest();
-
 	if((version.major > TIC_VERSION_MAJOR) ||
 		(version.major == TIC_VERSION_MAJOR && version.minor > TIC_VERSION_MINOR) ||
 		(version.major == TIC_VERSION_MAJOR && version.minor == TIC_VERSION_MINOR && version.patch > TIC_VERSION_REVISION))
 	{
 		char msg[FILENAME_MAX] = {0};
-		sprintf(msg, "\n A new version %i.%i.%i is available.\n", version.major, version.minor, version.patch);
-		consolePrint(console, msg, CONSOLE_BACK_TEXT_COLOR);
+		sprintf(msg, " A new version %i.%i.%i is available.\n", version.major, version.minor, version.patch);
+		printAbovePrompt(console, msg, CONSOLE_BACK_TEXT_COLOR);
 	}
 }
 
+static void checkNewVersion(Console* console)
+{
+	studioHttpGet("/api?fn=version", onVersionLoaded, console);
+}
+
 static void tick(Console* console)
 {
 	tic_mem* tic = console->tic;
 
+	flush(console);
+
 	// process scroll
 	{
 		tic80_input* input = &console->tic->ram.input;
@@ -3060,6 +3189,13 @@ static bool cmdInjectMap(Console* console, const char* param, const char* name)
 	return done;
 }
 
+#if defined(TIC80_TRACING)
+static bool cmdTrace(Console* console, const char* param, const char* path)
+{
+	return strcmp(param, "-trace") == 0 && startTracing(path);
+}
+#endif
+
 static bool checkUIScale(Console* console, const char* param, const char* value)
 {
 	bool done = false;
@@ -3099,6 +3235,7 @@ void initConsole(Console* console, tic_mem* tic, FileSystem* fs, Config* config,
 #endif
 		.error = error,
 		.trace = trace,
+		.flush = flush,
 		.tick = tick,
 		.save = saveCart,
 		.cursor = {.x = 0, .y = 0, .delay = 0},
@@ -3125,6 +3262,9 @@ void initConsole(Console* console, tic_mem* tic, FileSystem* fs, Config* config,
 		.active = false,
 		.buffer = console->buffer,
 		.colorBuffer = console->colorBuffer,
+		.bufferTop = 0,
+		.traces = console->traces,
+		.log = console->log,
 		.fs = fs,
 		.showGameMenu = false,
 		.startSurf = false,
@@ -3182,6 +3322,9 @@ void initConsole(Console* console, tic_mem* tic, FileSystem* fs, Config* config,
 				if(cmdInjectCode(console, first, second)
 					|| cmdInjectSprites(console, first, second)
 					|| cmdInjectMap(console, first, second)
+#if defined(TIC80_TRACING)
+					|| cmdTrace(console, first, second)
+#endif
 					|| checkUIScale(console, first, second))
 					argp |= mask;
 			}
@@ -3265,6 +3408,10 @@ void initConsole(Console* console, tic_mem* tic, FileSystem* fs, Config* config,
 
 #if defined(CAN_EXPORT)
 
+	if(!console->embed.yes)
+		loadEmbedFooter(console);
+
+	// binaries exported before the footer was added
 	if(!console->embed.yes)
 	{
 		s32 appSize = 0;
@@ -3313,3 +3460,13 @@ void initConsole(Console* console, tic_mem* tic, FileSystem* fs, Config* config,
 
 	console->active = !console->embed.yes;
 }
+
+void freeConsole(Console* console)
+{
+	free(console->buffer);
+	free(console->colorBuffer);
+	free(console->traces.data);
+
+	if(console->log.file && console->log.file != stdout)
+		fclose(console->log.file);
+}
@@ -78,9 +78,32 @@ struct Console
 	char* buffer;
 	u8* colorBuffer;
 
+	// ring buffer row that holds the first console line
+	s32 bufferTop;
+
+	struct
+	{
+		char* data;
+		s32 size;
+		s32 capacity;
+	} traces;
+
+	// mirror of the console output, at most `consoleLogRate` lines per second
+	struct
+	{
+		FILE* file;
+		char path[FILENAME_MAX];
+		s64 window;
+		s32 lines;
+		s32 skipped;
+	} log;
+
 	char inputBuffer[STUDIO_TEXT_BUFFER_WIDTH * STUDIO_TEXT_BUFFER_HEIGHT];
 	size_t inputPosition;
 
+	// nothing was printed after the last prompt
+	bool prompt;
+
 	tic_mem* tic;
 
 	struct FileSystem* fs;
@@ -103,14 +126,17 @@ struct Console
 		bool crtMonitor;
 	};
 
-	void(*load)(Console*, const char* path, const char* hash);
+	// carts with a hash are downloaded first, `done` is called once the load is over
+	void(*load)(Console*, const char* path, const char* hash, void(*done)(bool loaded, void* data), void* data);
 	bool(*loadProject)(Console*, const char* name, const char* data, s32 size, tic_cartridge* dst);
 	void(*updateProject)(Console*);
 	void(*error)(Console*, const char*);
 	void(*trace)(Console*, const char*, u8 color);
+	void(*flush)(Console*);
 	void(*tick)(Console*);
 
 	CartSaveResult(*save)(Console*);
 };
 
-void initConsole(Console*, tic_mem*, struct FileSystem* fs, struct Config* config, s32 argc, char **argv);
\ No newline at end of file
+void initConsole(Console*, tic_mem*, struct FileSystem* fs, struct Config* config, s32 argc, char **argv);
+void freeConsole(Console* console);
\ No newline at end of file
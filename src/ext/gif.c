@@ -266,156 +266,449 @@ static bool AddLoop(GifFileType *gif)
 			0  // 0 for infinite loop.
 		};
 
-		EGifPutExtensionLeader(gif, APPLICATION_EXT_FUNC_CODE);
-		EGifPutExtensionBlock(gif, 11, nsle);
-		EGifPutExtensionBlock(gif, 3, subblock);
-		EGifPutExtensionTrailer(gif);
+		return EGifPutExtensionLeader(gif, APPLICATION_EXT_FUNC_CODE) != GIF_ERROR
+			&& EGifPutExtensionBlock(gif, 11, nsle) != GIF_ERROR
+			&& EGifPutExtensionBlock(gif, 3, subblock) != GIF_ERROR
+			&& EGifPutExtensionTrailer(gif) != GIF_ERROR;
 	}
+}
 
-	return true;
+#define MIN(a,b) ((a) < (b) ? (a) : (b))
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+
+#define GIF_COLORS 256
+#define GIF_HASH_BITS 10
+#define GIF_HASH_SIZE (1 << GIF_HASH_BITS)
+
+typedef struct
+{
+	u32 keys[GIF_HASH_SIZE];
+	s16 values[GIF_HASH_SIZE];
+} ColorHash;
+
+static void resetHash(ColorHash* hash)
+{
+	memset(hash->values, -1, sizeof hash->values);
 }
 
-static const u8* toColor(const u8* ptr, gif_color* color)
+static s16* findHash(ColorHash* hash, u32 key)
 {
-	color->r = *ptr++;
-	color->g = *ptr++;
-	color->b = *ptr++;
-	ptr++;
+	u32 i = (key * 2654435761u) >> (32 - GIF_HASH_BITS);
+
+	while(hash->values[i] >= 0 && hash->keys[i] != key)
+		i = (i + 1) & (GIF_HASH_SIZE - 1);
 
-	return ptr;
+	hash->keys[i] = key;
+	return &hash->values[i];
 }
 
-bool gif_write_animation(const void* buffer, s32* size, s32 width, s32 height, const u8* data, s32 frames, s32 fps, s32 scale)
+static inline gif_color toColor(u32 pixel)
 {
-	bool result = false;
+	const u8* ptr = (const u8*)&pixel;
+	return (gif_color){ptr[0], ptr[1], ptr[2]};
+}
 
-	s32 swidth = width*scale, sheight = height*scale;
-	s32 frameSize = width * height;
+static inline u32 packColor(const gif_color* color)
+{
+	return color->r << 16 | color->g << 8 | color->b;
+}
 
-	enum{Bpp = 8, PalSize = 1 << Bpp, PalStructSize = PalSize * sizeof(gif_color)};
+static u8 findNearest(const gif_color* palette, s32 colors, gif_color color)
+{
+	s32 best = 0, min = 0x7fffffff;
 
-	s32 error = 0;
-	GifBuffer output = {buffer, 0};
-	GifFileType* gif = EGifOpen(&output, writeBuffer, &error);
+	for(s32 i = 0; i < colors; i++)
+	{
+		const gif_color* c = &palette[i];
+		s32 r = c->r - color.r, g = c->g - color.g, b = c->b - color.b;
+		s32 dist = r*r + g*g + b*b;
 
-	if(gif)
-	{			
-		EGifSetGifVersion(gif, true);
+		if(dist < min)
+		{
+			min = dist;
+			best = i;
+		}
+	}
+
+	return best;
+}
 
-		if(EGifPutScreenDesc(gif, swidth, sheight, Bpp, 0, NULL) != GIF_ERROR)
+s32 gif_index_frame(const u32* pixels, s32 size, u8* data, gif_color* palette)
+{
+	ColorHash hash;
+	resetHash(&hash);
+
+	s32 colors = 0;
+	u32 last = ~pixels[0];
+	u8 index = 0;
+
+	for(s32 i = 0; i < size; i++)
+	{
+		u32 pixel = pixels[i];
+
+		if(pixel != last)
 		{
-			if(AddLoop(gif))
+			last = pixel;
+
+			s16* value = findHash(&hash, pixel);
+
+			if(*value >= 0)
+				index = (u8)*value;
+			else if(colors < GIF_COLORS)
 			{
-				gif_color* palette = (gif_color*)malloc(PalStructSize);					
-				u8* screen = malloc(frameSize);
-				u8* line = malloc(swidth);
+				palette[colors] = toColor(pixel);
+				index = *value = colors++;
+			}
+			// a color that doesn't fit the table maps to the closest known one
+			else index = findNearest(palette, colors, toColor(pixel));
+		}
 
-				for(s32 f = 0; f < frames; f++)
-				{
-					enum {DelayUnits = 100, MinDelay = 2};
+		data[i] = index;
+	}
 
-					s32 frame = (f * fps * MinDelay * 2 + 1) / (2 * DelayUnits);
+	return colors;
+}
 
-					if(frame >= frames)
-						break;
+struct gif_writer
+{
+	GifFileType* gif;
 
-					s32 colors = 0;
-					const u8* ptr = data + frameSize*frame*sizeof(u32);
-					
-					{
-						memset(palette, 0, PalStructSize);
-						memset(screen, 0, frameSize);
+	s32 width;
+	s32 height;
+	s32 scale;
+	s32 frames;
+	bool error;
 
-						for(s32 i = 0; i < frameSize; i++)
-						{
-							if(colors >= PalSize) break;
+	u8* line;
+	u8* crop;
 
-							gif_color color;
-							toColor(ptr + i*sizeof(u32), &color);
+	// the previous frame as packed rgb, unchanged pixels are written transparent
+	u32* prev;
+	u32* next;
 
-							bool found = false;
-							for(s32 c = 0; c < colors; c++)
-							{
-								if(memcmp(&palette[c], &color, sizeof(gif_color)) == 0)
-								{
-									found = true;
-									screen[i] = c;
-									break;
-								}
-							}
+	// the first frame's colors are written once as the global table
+	gif_color global[GIF_COLORS];
+	s32 globalColors;
+	ColorHash globalHash;
+};
 
-							if(!found)
-							{
-								// TODO: check for last color in palette and try to find closest color
-								screen[i] = colors;
-								memcpy(&palette[colors], &color, sizeof(gif_color));
-								colors++;
-							}
-						}
-					}
+static void freeWriter(gif_writer* writer)
+{
+	free(writer->line);
+	free(writer->crop);
+	free(writer->prev);
+	free(writer->next);
+	free(writer);
+}
 
-					{
-						GraphicsControlBlock gcb = 
-						{
-							.DisposalMode = DISPOSE_DO_NOT,
-							.UserInputFlag = false,
-							.DelayTime = MinDelay,
-							.TransparentColor = -1,
-						};
-
-						u8 ext[4];
-						EGifGCBToExtension(&gcb, ext);
-						EGifPutExtension(gif, GRAPHICS_EXT_FUNC_CODE, sizeof ext, ext);
-					}
+static gif_writer* createWriter(s32 width, s32 height, s32 scale)
+{
+	gif_writer* writer = (gif_writer*)calloc(1, sizeof(gif_writer));
 
-					ColorMapObject* colorMap = GifMakeMapObject(PalSize, NULL);
-					memset(colorMap->Colors, 0, PalStructSize);
-					memcpy(colorMap->Colors, palette, colors * sizeof(GifColorType));
+	if(writer)
+	{
+		s32 size = width * height;
 
-					if(EGifPutImageDesc(gif, 0, 0, swidth, sheight, false, colorMap) != GIF_ERROR)
-					{
-						for(s32 y = 0; y < height; y++)
-						{
-							for(s32 x = 0, pos = y*width; x < width; x++, pos++)
-							{
-								u8 color = screen[pos];
-								for(s32 s = 0, pos = x*scale; s < scale; s++, pos++)
-									line[pos] = color;
-							}
+		writer->width = width;
+		writer->height = height;
+		writer->scale = scale;
+		writer->line = malloc(width * scale);
+		writer->crop = malloc(size);
+		writer->prev = malloc(size * sizeof(u32));
+		writer->next = malloc(size * sizeof(u32));
 
-							for(s32 s = 0; s < scale; s++)
-							{
-								if (EGifPutLine(gif, line, swidth) == GIF_ERROR)
-								{
-									error = gif->Error;
-									break;
-								}
-							}
+		if(!writer->line || !writer->crop || !writer->prev || !writer->next)
+		{
+			freeWriter(writer);
+			return NULL;
+		}
+	}
 
-							if(error != E_GIF_SUCCEEDED) break;
-						}
+	return writer;
+}
 
-						*size = output.pos;
+static bool startWriter(gif_writer* writer, const gif_color* palette, s32 colors)
+{
+	GifFileType* gif = writer->gif;
 
-						result = error == E_GIF_SUCCEEDED;
-					}
+	writer->globalColors = colors;
+	memcpy(writer->global, palette, colors * sizeof(gif_color));
 
-					GifFreeMapObject(colorMap);
+	resetHash(&writer->globalHash);
+	for(s32 i = 0; i < colors; i++)
+		*findHash(&writer->globalHash, packColor(&palette[i])) = i;
 
-					if(!result)
-						break;
-				}
+	// one spare entry is left for the transparent index when possible
+	ColorMapObject* colorMap = GifMakeMapObject(1 << GifBitSize(MIN(colors + 1, GIF_COLORS)), NULL);
+
+	if(!colorMap)
+		return false;
+
+	memcpy(colorMap->Colors, palette, colors * sizeof(GifColorType));
+
+	EGifSetGifVersion(gif, true);
+
+	bool result = EGifPutScreenDesc(gif, writer->width * writer->scale, writer->height * writer->scale, 8, 0, colorMap) != GIF_ERROR 
+		&& AddLoop(gif);
+
+	GifFreeMapObject(colorMap);
+
+	return result;
+}
+
+// returns false when some color is missing from the global table
+static bool mapToGlobal(gif_writer* writer, const gif_color* palette, s32 colors, u8* remap)
+{
+	for(s32 i = 0; i < colors; i++)
+	{
+		s16 value = *findHash(&writer->globalHash, packColor(&palette[i]));
+
+		if(value < 0)
+			return false;
+
+		remap[i] = (u8)value;
+	}
+
+	return true;
+}
+
+static bool getChangedRect(const gif_writer* writer, s32* left, s32* top, s32* right, s32* bottom)
+{
+	s32 width = writer->width;
+	*left = width, *top = writer->height, *right = -1, *bottom = -1;
+
+	for(s32 y = 0; y < writer->height; y++)
+	{
+		const u32* prev = writer->prev + y * width;
+		const u32* next = writer->next + y * width;
+
+		if(memcmp(prev, next, width * sizeof(u32)) == 0)
+			continue;
+
+		s32 l = 0, r = width - 1;
+		while(prev[l] == next[l]) l++;
+		while(prev[r] == next[r]) r--;
+
+		*left = MIN(*left, l);
+		*right = MAX(*right, r);
+		*top = MIN(*top, y);
+		*bottom = y;
+	}
+
+	return *right >= 0;
+}
 
-				free(line);
-				free(screen);
-				free(palette);
+bool gif_writer_frame(gif_writer* writer, const u8* data, const gif_color* palette, s32 colors, s32 delay)
+{
+	if(writer->error)
+		return false;
+
+	if(colors < 1) colors = 1;
+	else if(colors > GIF_COLORS) colors = GIF_COLORS;
+
+	GifFileType* gif = writer->gif;
+	s32 width = writer->width, scale = writer->scale;
+
+	{
+		u32 packed[GIF_COLORS];
+		for(s32 i = 0; i < colors; i++)
+			packed[i] = packColor(&palette[i]);
+
+		for(s32 i = 0, size = width * writer->height; i < size; i++)
+			writer->next[i] = packed[data[i]];
+	}
+
+	if(writer->frames == 0 && !startWriter(writer, palette, colors))
+	{
+		writer->error = true;
+		return false;
+	}
+
+	u8 remap[GIF_COLORS];
+	bool global = mapToGlobal(writer, palette, colors, remap);
+
+	s32 tableColors = global ? writer->globalColors : colors;
+	s32 transparent = writer->frames > 0 && tableColors < GIF_COLORS ? tableColors : NO_TRANSPARENT_COLOR;
+
+	s32 left = 0, top = 0, right = width - 1, bottom = writer->height - 1;
+
+	// an unchanged frame still has to be written to keep the timing
+	if(writer->frames > 0 && !getChangedRect(writer, &left, &top, &right, &bottom))
+		left = right = top = bottom = 0;
+
+	s32 cw = right - left + 1, ch = bottom - top + 1;
+
+	{
+		GraphicsControlBlock gcb = 
+		{
+			.DisposalMode = DISPOSE_DO_NOT,
+			.UserInputFlag = false,
+			.DelayTime = delay,
+			.TransparentColor = transparent,
+		};
+
+		u8 ext[4];
+		EGifGCBToExtension(&gcb, ext);
+
+		if(EGifPutExtension(gif, GRAPHICS_EXT_FUNC_CODE, sizeof ext, ext) == GIF_ERROR)
+		{
+			writer->error = true;
+			return false;
+		}
+	}
+
+	for(s32 y = 0; y < ch; y++)
+	{
+		s32 pos = (y + top) * width + left;
+		const u8* src = data + pos;
+		const u32* prev = writer->prev + pos;
+		const u32* next = writer->next + pos;
+		u8* dst = writer->crop + y * cw;
+
+		for(s32 x = 0; x < cw; x++)
+			dst[x] = transparent >= 0 && prev[x] == next[x] 
+				? transparent 
+				: global ? remap[src[x]] : src[x];
+	}
+
+	ColorMapObject* colorMap = NULL;
+
+	if(!global)
+	{
+		colorMap = GifMakeMapObject(1 << GifBitSize(MIN(colors + 1, GIF_COLORS)), NULL);
+
+		if(!colorMap)
+		{
+			writer->error = true;
+			return false;
+		}
+
+		memcpy(colorMap->Colors, palette, colors * sizeof(GifColorType));
+	}
+
+	s32 swidth = cw * scale;
+
+	if(EGifPutImageDesc(gif, left * scale, top * scale, swidth, ch * scale, false, colorMap) == GIF_ERROR)
+		writer->error = true;
+
+	for(s32 y = 0; y < ch && !writer->error; y++)
+	{
+		u8* line = writer->crop + y * cw;
+
+		if(scale > 1)
+		{
+			for(s32 x = 0, pos = 0; x < cw; x++)
+				for(s32 s = 0; s < scale; s++)
+					writer->line[pos++] = line[x];
+
+			line = writer->line;
+		}
+
+		for(s32 s = 0; s < scale; s++)
+		{
+			if(EGifPutLine(gif, line, swidth) == GIF_ERROR)
+			{
+				writer->error = true;
+				break;
 			}
 		}
+	}
 
-		EGifCloseFile(gif, &error);
+	if(colorMap)
+		GifFreeMapObject(colorMap);
 
-		*size = output.pos;
+	{
+		u32* tmp = writer->prev;
+		writer->prev = writer->next;
+		writer->next = tmp;
+	}
+
+	writer->frames++;
+
+	return !writer->error;
+}
+
+static bool closeWriter(gif_writer* writer)
+{
+	s32 error = 0;
+	bool result = writer->frames > 0 && !writer->error;
+
+	if(EGifCloseFile(writer->gif, &error) == GIF_ERROR)
+		result = false;
+
+	freeWriter(writer);
+
+	return result;
+}
+
+gif_writer* gif_writer_open(const char* path, s32 width, s32 height, s32 scale)
+{
+	gif_writer* writer = createWriter(width, height, scale);
+
+	if(writer)
+	{
+		s32 error = 0;
+		writer->gif = EGifOpenFileName(path, false, &error);
+
+		if(!writer->gif)
+		{
+			freeWriter(writer);
+			return NULL;
+		}
+	}
+
+	return writer;
+}
+
+bool gif_writer_close(gif_writer* writer)
+{
+	return closeWriter(writer);
+}
+
+bool gif_write_animation(const void* buffer, s32* size, s32 width, s32 height, const u8* data, s32 frames, s32 fps, s32 scale)
+{
+	gif_writer* writer = createWriter(width, height, scale);
+
+	if(!writer)
+		return false;
+
+	s32 error = 0;
+	GifBuffer output = {buffer, 0};
+	writer->gif = EGifOpen(&output, writeBuffer, &error);
+
+	if(!writer->gif)
+	{
+		freeWriter(writer);
+		return false;
 	}
 
+	s32 frameSize = width * height;
+	u8* screen = malloc(frameSize);
+	gif_color* palette = malloc(GIF_COLORS * sizeof(gif_color));
+
+	if(screen && palette)
+	{
+		for(s32 f = 0; f < frames; f++)
+		{
+			enum {DelayUnits = 100, MinDelay = 2};
+
+			s32 frame = (f * fps * MinDelay * 2 + 1) / (2 * DelayUnits);
+
+			if(frame >= frames)
+				break;
+
+			s32 colors = gif_index_frame((const u32*)data + frameSize*frame, frameSize, screen, palette);
+
+			if(!gif_writer_frame(writer, screen, palette, colors, MinDelay))
+				break;
+		}
+	}
+
+	free(palette);
+	free(screen);
+
+	bool result = closeWriter(writer);
+	*size = output.pos;
+
 	return result;
-}
\ No newline at end of file
+}
@@ -47,3 +47,13 @@ gif_image* gif_read_data(const void* buffer, s32 size);
 bool gif_write_data(const void* buffer, s32* size, s32 width, s32 height, const u8* data, const gif_color* palette, u8 bpp);
 bool gif_write_animation(const void* buffer, s32* size, s32 width, s32 height, const u8* data, s32 frames, s32 fps, s32 scale);
 void gif_close(gif_image* image);
+
+// maps 32-bit pixels to palette indices, returns the number of colors (up to 256)
+s32 gif_index_frame(const u32* pixels, s32 size, u8* data, gif_color* palette);
+
+// streams an animation to a file frame by frame, data is one palette index per pixel
+typedef struct gif_writer gif_writer;
+
+gif_writer* gif_writer_open(const char* path, s32 width, s32 height, s32 scale);
+bool gif_writer_frame(gif_writer* writer, const u8* data, const gif_color* palette, s32 colors, s32 delay);
+bool gif_writer_close(gif_writer* writer);
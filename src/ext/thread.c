@@ -0,0 +1,253 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "thread.h"
+
+#include <stdlib.h>
+
+#if defined(TIC_NO_THREADS)
+
+tic_thread* tic_thread_create(void(*func)(void*), void* data) {return NULL;}
+void tic_thread_join(tic_thread* thread) {}
+
+tic_mutex* tic_mutex_create() {return NULL;}
+void tic_mutex_lock(tic_mutex* mutex) {}
+void tic_mutex_unlock(tic_mutex* mutex) {}
+void tic_mutex_delete(tic_mutex* mutex) {}
+
+tic_cond* tic_cond_create() {return NULL;}
+void tic_cond_wait(tic_cond* cond, tic_mutex* mutex) {}
+void tic_cond_broadcast(tic_cond* cond) {}
+void tic_cond_delete(tic_cond* cond) {}
+
+#elif defined(__TIC_WINDOWS__)
+
+#include <windows.h>
+
+struct tic_thread
+{
+	HANDLE handle;
+	void(*func)(void*);
+	void* data;
+};
+
+struct tic_mutex
+{
+	CRITICAL_SECTION section;
+};
+
+struct tic_cond
+{
+	CONDITION_VARIABLE var;
+};
+
+static DWORD WINAPI threadProc(LPVOID param)
+{
+	tic_thread* thread = (tic_thread*)param;
+	thread->func(thread->data);
+	return 0;
+}
+
+tic_thread* tic_thread_create(void(*func)(void*), void* data)
+{
+	tic_thread* thread = (tic_thread*)malloc(sizeof(tic_thread));
+
+	if(thread)
+	{
+		thread->func = func;
+		thread->data = data;
+		thread->handle = CreateThread(NULL, 0, threadProc, thread, 0, NULL);
+
+		if(!thread->handle)
+		{
+			free(thread);
+			return NULL;
+		}
+	}
+
+	return thread;
+}
+
+void tic_thread_join(tic_thread* thread)
+{
+	WaitForSingleObject(thread->handle, INFINITE);
+	CloseHandle(thread->handle);
+	free(thread);
+}
+
+tic_mutex* tic_mutex_create()
+{
+	tic_mutex* mutex = (tic_mutex*)malloc(sizeof(tic_mutex));
+
+	if(mutex)
+		InitializeCriticalSection(&mutex->section);
+
+	return mutex;
+}
+
+void tic_mutex_lock(tic_mutex* mutex)
+{
+	EnterCriticalSection(&mutex->section);
+}
+
+void tic_mutex_unlock(tic_mutex* mutex)
+{
+	LeaveCriticalSection(&mutex->section);
+}
+
+void tic_mutex_delete(tic_mutex* mutex)
+{
+	DeleteCriticalSection(&mutex->section);
+	free(mutex);
+}
+
+tic_cond* tic_cond_create()
+{
+	tic_cond* cond = (tic_cond*)malloc(sizeof(tic_cond));
+
+	if(cond)
+		InitializeConditionVariable(&cond->var);
+
+	return cond;
+}
+
+void tic_cond_wait(tic_cond* cond, tic_mutex* mutex)
+{
+	SleepConditionVariableCS(&cond->var, &mutex->section, INFINITE);
+}
+
+void tic_cond_broadcast(tic_cond* cond)
+{
+	WakeAllConditionVariable(&cond->var);
+}
+
+void tic_cond_delete(tic_cond* cond)
+{
+	free(cond);
+}
+
+#else
+
+#include <pthread.h>
+
+struct tic_thread
+{
+	pthread_t handle;
+	void(*func)(void*);
+	void* data;
+};
+
+struct tic_mutex
+{
+	pthread_mutex_t handle;
+};
+
+struct tic_cond
+{
+	pthread_cond_t handle;
+};
+
+static void* threadProc(void* param)
+{
+	tic_thread* thread = (tic_thread*)param;
+	thread->func(thread->data);
+	return NULL;
+}
+
+tic_thread* tic_thread_create(void(*func)(void*), void* data)
+{
+	tic_thread* thread = (tic_thread*)malloc(sizeof(tic_thread));
+
+	if(thread)
+	{
+		thread->func = func;
+		thread->data = data;
+
+		if(pthread_create(&thread->handle, NULL, threadProc, thread) != 0)
+		{
+			free(thread);
+			return NULL;
+		}
+	}
+
+	return thread;
+}
+
+void tic_thread_join(tic_thread* thread)
+{
+	pthread_join(thread->handle, NULL);
+	free(thread);
+}
+
+tic_mutex* tic_mutex_create()
+{
+	tic_mutex* mutex = (tic_mutex*)malloc(sizeof(tic_mutex));
+
+	if(mutex)
+		pthread_mutex_init(&mutex->handle, NULL);
+
+	return mutex;
+}
+
+void tic_mutex_lock(tic_mutex* mutex)
+{
+	pthread_mutex_lock(&mutex->handle);
+}
+
+void tic_mutex_unlock(tic_mutex* mutex)
+{
+	pthread_mutex_unlock(&mutex->handle);
+}
+
+void tic_mutex_delete(tic_mutex* mutex)
+{
+	pthread_mutex_destroy(&mutex->handle);
+	free(mutex);
+}
+
+tic_cond* tic_cond_create()
+{
+	tic_cond* cond = (tic_cond*)malloc(sizeof(tic_cond));
+
+	if(cond)
+		pthread_cond_init(&cond->handle, NULL);
+
+	return cond;
+}
+
+void tic_cond_wait(tic_cond* cond, tic_mutex* mutex)
+{
+	pthread_cond_wait(&cond->handle, &mutex->handle);
+}
+
+void tic_cond_broadcast(tic_cond* cond)
+{
+	pthread_cond_broadcast(&cond->handle);
+}
+
+void tic_cond_delete(tic_cond* cond)
+{
+	pthread_cond_destroy(&cond->handle);
+	free(cond);
+}
+
+#endif
@@ -0,0 +1,48 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <tic80_types.h>
+#include <tic80_config.h>
+
+#if defined(__EMSCRIPTEN__) || defined(BAREMETALPI) || defined(__TIC_WINRT__)
+#	define TIC_NO_THREADS 1
+#endif
+
+typedef struct tic_thread tic_thread;
+typedef struct tic_mutex tic_mutex;
+typedef struct tic_cond tic_cond;
+
+// returns NULL when threads are not available, callers have to do the work inline
+tic_thread* tic_thread_create(void(*func)(void*), void* data);
+void tic_thread_join(tic_thread* thread);
+
+tic_mutex* tic_mutex_create();
+void tic_mutex_lock(tic_mutex* mutex);
+void tic_mutex_unlock(tic_mutex* mutex);
+void tic_mutex_delete(tic_mutex* mutex);
+
+tic_cond* tic_cond_create();
+void tic_cond_wait(tic_cond* cond, tic_mutex* mutex);
+void tic_cond_broadcast(tic_cond* cond);
+void tic_cond_delete(tic_cond* cond);
@@ -0,0 +1,150 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "fill.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+	const tic_rect* clip;
+	bool(*match)(void* data, s32 x, s32 y);
+	void* data;
+
+	u8* visited;
+
+	struct
+	{
+		tic_point* items;
+		s32 count;
+		s32 size;
+	} stack;
+} Fill;
+
+static bool test(Fill* fill, s32 x, s32 y)
+{
+	const tic_rect* clip = fill->clip;
+	s32 index = (x - clip->x) + (y - clip->y) * clip->w;
+
+	return !(fill->visited[index >> 3] & (1 << (index & 7))) && fill->match(fill->data, x, y);
+}
+
+static void visit(Fill* fill, s32 x, s32 y, s32 width)
+{
+	const tic_rect* clip = fill->clip;
+
+	for(s32 index = (x - clip->x) + (y - clip->y) * clip->w, end = index + width; index < end; index++)
+		fill->visited[index >> 3] |= 1 << (index & 7);
+}
+
+static bool push(Fill* fill, s32 x, s32 y)
+{
+	if(fill->stack.count == fill->stack.size)
+	{
+		s32 size = fill->stack.size ? fill->stack.size * 2 : 256;
+		tic_point* items = realloc(fill->stack.items, size * sizeof(tic_point));
+
+		if(!items) return false;
+
+		fill->stack.items = items;
+		fill->stack.size = size;
+	}
+
+	fill->stack.items[fill->stack.count++] = (tic_point){x, y};
+
+	return true;
+}
+
+// queues the start of every run of fillable cells on row `y` between `l` and `r`
+static bool seed(Fill* fill, s32 l, s32 r, s32 y)
+{
+	const tic_rect* clip = fill->clip;
+
+	if(y < clip->y || y >= clip->y + clip->h)
+		return true;
+
+	bool inside = false;
+
+	for(s32 x = l; x <= r; x++)
+	{
+		bool match = test(fill, x, y);
+
+		if(match && !inside && !push(fill, x, y))
+			return false;
+
+		inside = match;
+	}
+
+	return true;
+}
+
+bool flood_fill(const tic_rect* clip, s32 x, s32 y,
+	bool(*match)(void* data, s32 x, s32 y),
+	void(*callback)(void* data, s32 x, s32 y, s32 width),
+	void* data)
+{
+	if(clip->w <= 0 || clip->h <= 0
+		|| x < clip->x || x >= clip->x + clip->w
+		|| y < clip->y || y >= clip->y + clip->h)
+		return true;
+
+	Fill fill =
+	{
+		.clip = clip,
+		.match = match,
+		.data = data,
+		.visited = calloc((clip->w * clip->h + 7) / 8, 1),
+	};
+
+	bool done = fill.visited && push(&fill, x, y);
+
+	if(done)
+	{
+		while(fill.stack.count)
+		{
+			tic_point point = fill.stack.items[--fill.stack.count];
+
+			if(!test(&fill, point.x, point.y))
+				continue;
+
+			s32 l = point.x, r = point.x;
+
+			while(l > clip->x && test(&fill, l - 1, point.y)) l--;
+			while(r < clip->x + clip->w - 1 && test(&fill, r + 1, point.y)) r++;
+
+			visit(&fill, l, point.y, r - l + 1);
+			callback(data, l, point.y, r - l + 1);
+
+			if(!seed(&fill, l, r, point.y - 1) || !seed(&fill, l, r, point.y + 1))
+			{
+				done = false;
+				break;
+			}
+		}
+	}
+
+	free(fill.stack.items);
+	free(fill.visited);
+
+	return done;
+}
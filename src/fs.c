@@ -23,6 +23,7 @@
 #include "studio.h"
 #include "fs.h"
 #include "ext/file_dialog.h"
+#include "tracing.h"
 
 #if defined(BAREMETALPI)
 #include "../../circle-stdlib/libs/circle/addon/fatfs/ff.h"
@@ -43,6 +44,10 @@
 #include <unistd.h>
 #endif
 
+#if defined(__TIC_LINUX__)
+#include <sys/inotify.h>
+#endif
+
 #if defined(__EMSCRIPTEN__)
 #include <emscripten.h>
 #endif
@@ -183,10 +188,11 @@ typedef char fsString;
 typedef struct
 {
 	ListCallback callback;
+	DoneCallback done;
 	void* data;
 } NetDirData;
 
-static lua_State* netLuaInit(u8* buffer, s32 size)
+static lua_State* netLuaInit(const u8* buffer, s32 size)
 {
     if (buffer && size)
     {
@@ -209,14 +215,13 @@ static lua_State* netLuaInit(u8* buffer, s32 size)
     return NULL;
 }
 
-static void onDirResponse(u8* buffer, s32 size, void* data)
+static void onDirResponse(const u8* buffer, s32 size, void* data)
 {
 	NetDirData* netDirData = (NetDirData*)data;
 
 	if(buffer && size)
 	{
 		lua_State* lua = netLuaInit(buffer, size);
-		free(buffer);
 
 		if(lua)
 		{
@@ -298,16 +303,35 @@ static void onDirResponse(u8* buffer, s32 size, void* data)
 	}
 }
 
-static void netDirRequest(const char* path, ListCallback callback, void* data)
+static void onDirLoaded(const HttpGetData* data)
+{
+	NetDirData* netDirData = (NetDirData*)data->calldata;
+
+	// the studio is gone when the net closes with the request pending
+	if(data->status != HttpGetCancel)
+	{
+		if(data->status == HttpGetDone)
+			onDirResponse(data->data, data->size, netDirData);
+
+		netDirData->done(netDirData->data);
+	}
+
+	free(netDirData);
+}
+
+static void netDirRequest(const char* path, ListCallback callback, DoneCallback done, void* data)
 {
 	char request[FILENAME_MAX] = {'\0'};
 	sprintf(request, "/api?fn=dir&path=%s", path);
 
-	s32 size = 0;
-	void* buffer = getSystem()->getUrlRequest(request, &size);
+	NetDirData* netDirData = (NetDirData*)malloc(sizeof(NetDirData));
 
-	NetDirData netDirData = {callback, data};
-	onDirResponse(buffer, size, &netDirData);
+	if(netDirData)
+	{
+		*netDirData = (NetDirData){callback, done, data};
+		studioHttpGet(request, onDirLoaded, netDirData);
+	}
+	else done(data);
 }
 
 static void enumFiles(FileSystem* fs, const char* path, ListCallback callback, void* data, bool folder)
@@ -394,11 +418,8 @@ void fsEnumFiles(FileSystem* fs, ListCallback callback, void* data)
 {
 	if(isRoot(fs) && !callback(PublicDir, NULL, 0, data, true))return;
 
-	if(isPublic(fs))
-	{
-		netDirRequest(fs->work + sizeof(TIC_HOST), callback, data);
-		return;
-	}
+	// public folders are only listed by fsEnumFilesAsync
+	if(isPublic(fs)) return;
 
 	const char* path = getFilePath(fs, "");
 
@@ -406,6 +427,18 @@ void fsEnumFiles(FileSystem* fs, ListCallback callback, void* data)
 	enumFiles(fs, path, callback, data, false);
 }
 
+void fsEnumFilesAsync(FileSystem* fs, ListCallback callback, DoneCallback done, void* data)
+{
+	if(isPublic(fs))
+	{
+		netDirRequest(fs->work + sizeof(TIC_HOST), callback, done, data);
+		return;
+	}
+
+	fsEnumFiles(fs, callback, data);
+	done(data);
+}
+
 bool fsDeleteDir(FileSystem* fs, const char* name)
 {
 #if defined(BAREMETALPI)
@@ -594,14 +627,19 @@ void fsGetDir(FileSystem* fs, char* dir)
 	strcpy(dir, fs->work);
 }
 
+static void changeDir(FileSystem* fs, const char* dir)
+{
+	if(strlen(fs->work))
+		strcat(fs->work, "/");
+			
+	strcat(fs->work, dir);
+}
+
 bool fsChangeDir(FileSystem* fs, const char* dir)
 {
 	if(fsIsDir(fs, dir))
 	{
-		if(strlen(fs->work))
-			strcat(fs->work, "/");
-				
-		strcat(fs->work, dir);
+		changeDir(fs, dir);
 
 		return true;
 	}
@@ -611,8 +649,12 @@ bool fsChangeDir(FileSystem* fs, const char* dir)
 
 typedef struct
 {
-	const char* name;
+	FileSystem* fs;
+	char name[FILENAME_MAX];
 	bool found;
+	bool change;
+	IsDirCallback callback;
+	void* data;
 
 } EnumPublicDirsData;
 
@@ -629,6 +671,58 @@ static bool onEnumPublicDirs(const char* name, const char* info, s32 id, void* d
 	return true;
 }
 
+static void onEnumPublicDirsDone(void* data)
+{
+	EnumPublicDirsData* enumPublicDirsData = (EnumPublicDirsData*)data;
+
+	// the folder could be left while the listing was loading
+	if(enumPublicDirsData->change && enumPublicDirsData->found && isPublicRoot(enumPublicDirsData->fs))
+		changeDir(enumPublicDirsData->fs, enumPublicDirsData->name);
+
+	enumPublicDirsData->callback(enumPublicDirsData->found, enumPublicDirsData->data);
+
+	free(enumPublicDirsData);
+}
+
+static void isDirAsync(FileSystem* fs, const char* name, bool change, IsDirCallback callback, void* data)
+{
+	if(*name != '.' && isPublicRoot(fs) && strlen(name) < FILENAME_MAX)
+	{
+		EnumPublicDirsData* enumPublicDirsData = (EnumPublicDirsData*)malloc(sizeof(EnumPublicDirsData));
+
+		if(enumPublicDirsData)
+		{
+			*enumPublicDirsData = (EnumPublicDirsData)
+			{
+				.fs = fs,
+				.found = false,
+				.change = change,
+				.callback = callback,
+				.data = data,
+			};
+
+			strcpy(enumPublicDirsData->name, name);
+
+			fsEnumFilesAsync(fs, onEnumPublicDirs, onEnumPublicDirsDone, enumPublicDirsData);
+		}
+		else callback(false, data);
+
+		return;
+	}
+
+	callback(change ? fsChangeDir(fs, name) : fsIsDir(fs, name), data);
+}
+
+void fsIsDirAsync(FileSystem* fs, const char* name, IsDirCallback callback, void* data)
+{
+	isDirAsync(fs, name, false, callback, data);
+}
+
+void fsChangeDirAsync(FileSystem* fs, const char* dir, IsDirCallback callback, void* data)
+{
+	isDirAsync(fs, dir, true, callback, data);
+}
+
 bool fsIsDir(FileSystem* fs, const char* name)
 {
 	if(*name == '.') return false;
@@ -645,18 +739,9 @@ bool fsIsDir(FileSystem* fs, const char* name)
 	if(isRoot(fs) && strcmp(name, PublicDir) == 0)
 		return true;
 
+	// public folders are only known to fsIsDirAsync
 	if(isPublicRoot(fs))
-	{
-		EnumPublicDirsData enumPublicDirsData =
-		{
-			.name = name,
-			.found = false,
-		};
-
-		fsEnumFiles(fs, onEnumPublicDirs, &enumPublicDirsData);
-
-		return enumPublicDirsData.found;
-	}
+		return false;
 
 	const char* path = getFilePath(fs, name);
 	struct tic_stat_struct s;
@@ -717,7 +802,7 @@ void fsGetFile(FileSystem* fs, GetCallback callback, const char* name, void* dat
 	else callback(FS_FILE_NOT_DOWNLOADED, data);
 }
 
-bool fsWriteFile(const char* name, const void* buffer, s32 size)
+static bool writeFile(const char* name, const void* buffer, s32 size)
 {
 #if defined(BAREMETALPI)
 	dbg("fsWriteFile %s\n", name);
@@ -764,6 +849,67 @@ bool fsWriteFile(const char* name, const void* buffer, s32 size)
 #endif
 }
 
+bool fsWriteFile(const char* name, const void* buffer, s32 size)
+{
+	TRACE_BEGIN("fs write");
+	bool done = writeFile(name, buffer, size);
+	TRACE_END("fs write");
+
+	return done;
+}
+
+// runs on the pmem writer thread, so it stays out of the trace
+bool fsWriteFileAtomic(const char* name, const void* buffer, s32 size)
+{
+#if defined(BAREMETALPI) || defined(__EMSCRIPTEN__)
+	return writeFile(name, buffer, size);
+#else
+	char temp[FILENAME_MAX];
+	snprintf(temp, sizeof temp, "%s.tmp", name);
+
+	const fsString* tempString = utf8ToString(temp);
+	FILE* file = tic_fopen(tempString, _S("wb"));
+
+	bool done = false;
+
+	if(file)
+	{
+		done = fwrite(buffer, 1, size, file) == (size_t)size;
+		done = fclose(file) == 0 && done;
+	}
+
+	if(done)
+	{
+		const fsString* pathString = utf8ToString(name);
+
+#if defined(__TIC_WINDOWS__) || defined(__TIC_WINRT__)
+		done = MoveFileExW(tempString, pathString, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+		done = rename(tempString, pathString) == 0;
+#endif
+		freeString(pathString);
+	}
+
+	if(!done && file)
+		tic_remove(tempString);
+
+	freeString(tempString);
+
+	return done;
+#endif
+}
+
+void fsGetRootFilePath(FileSystem* fs, const char* name, char* out)
+{
+	char path[FILENAME_MAX];
+	strcpy(path, fs->work);
+	fsHomeDir(fs);
+
+	strcpy(out, getFilePath(fs, name));
+
+	strcpy(fs->work, path);
+}
+
 bool fsCopyFile(const char* src, const char* dst)
 {
 #if defined(BAREMETALPI)
@@ -835,6 +981,8 @@ void* fsReadFile(const char* path, s32* size)
 	return buffer;
 
 #else
+	TRACE_BEGIN("fs read");
+
 	const fsString* pathString = utf8ToString(path);
 	FILE* file = tic_fopen(pathString, _S("rb"));
 	freeString(pathString);
@@ -853,11 +1001,38 @@ void* fsReadFile(const char* path, s32* size)
 		fclose(file);
 	}
 
+	TRACE_END("fs read");
+
 	return buffer;
 
 #endif
 }
 
+bool fsReadFileRange(const char* path, s32 offset, void* buffer, s32 size)
+{
+#if defined(BAREMETALPI)
+	// TODO BAREMETALPI
+	dbg("fsReadFileRange %s\n", path);
+	return false;
+#else
+	const fsString* pathString = utf8ToString(path);
+	FILE* file = tic_fopen(pathString, _S("rb"));
+	freeString(pathString);
+
+	bool done = false;
+
+	if(file)
+	{
+		if(fseek(file, offset, offset < 0 ? SEEK_END : SEEK_SET) == 0)
+			done = fread(buffer, size, 1, file) == 1;
+
+		fclose(file);
+	}
+
+	return done;
+#endif
+}
+
 static void makeDir(const char* name)
 {
 #if defined(BAREMETALPI)
@@ -1002,16 +1177,16 @@ bool fsExistsFile(FileSystem* fs, const char* name)
 	return fsExists(getFilePath(fs, name));
 }
 
-u64 fsMDate(FileSystem* fs, const char* name)
+static u64 getMDate(const char* path)
 {
 #if defined(BAREMETALPI)
-	dbg("fsMDate %s\n", name);
+	dbg("getMDate %s\n", path);
 	// TODO BAREMETALPI
 	return 0;
 #else
 	struct tic_stat_struct s;
 
-	const fsString* pathString = utf8ToString(getFilePath(fs, name));
+	const fsString* pathString = utf8ToString(path);
 	s32 ret = tic_stat(pathString, &s);
 	freeString(pathString);
 
@@ -1024,6 +1199,217 @@ u64 fsMDate(FileSystem* fs, const char* name)
 #endif
 }
 
+u64 fsMDate(FileSystem* fs, const char* name)
+{
+	return getMDate(getFilePath(fs, name));
+}
+
+#if defined(__TIC_LINUX__)
+#define WATCHER_INOTIFY
+#endif
+
+#define WATCHER_ENTRIES 8
+#define WATCHER_POLL_PERIOD 30 // frames between stat checks when there are no notifications
+
+typedef struct
+{
+	s32 id;
+	char path[FILENAME_MAX];
+	u64 mdate;
+	bool pending;
+
+#if defined(WATCHER_INOTIFY)
+	s32 wd;
+#endif
+} WatchEntry;
+
+struct FileWatcher
+{
+	WatchEntry entries[WATCHER_ENTRIES];
+	s32 count;
+	s32 ticks;
+
+#if defined(WATCHER_INOTIFY)
+	s32 fd;
+#endif
+};
+
+FileWatcher* fsCreateWatcher()
+{
+	FileWatcher* watcher = (FileWatcher*)calloc(1, sizeof(FileWatcher));
+
+#if defined(WATCHER_INOTIFY)
+	if(watcher)
+		watcher->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+
+	return watcher;
+}
+
+static WatchEntry* getWatchEntry(FileWatcher* watcher, s32 id)
+{
+	for(s32 i = 0; i < watcher->count; i++)
+		if(watcher->entries[i].id == id)
+			return &watcher->entries[i];
+
+	return NULL;
+}
+
+#if defined(WATCHER_INOTIFY)
+
+static const char* getWatchName(const char* path)
+{
+	const char* name = strrchr(path, '/');
+	return name ? name + 1 : path;
+}
+
+// editors often save by renaming a temp file over the original, so the folder is watched rather than the file,
+// only finished writes and renames count so a file isn't picked up while it's still empty or half written
+static s32 addDirWatch(FileWatcher* watcher, const char* path)
+{
+	char dir[FILENAME_MAX];
+	strcpy(dir, path);
+
+	char* name = strrchr(dir, '/');
+
+	if(name == dir) name[1] = '\0';
+	else if(name) *name = '\0';
+	else strcpy(dir, ".");
+
+	return watcher->fd < 0 ? -1 : inotify_add_watch(watcher->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+}
+
+static void removeDirWatch(FileWatcher* watcher, const WatchEntry* entry)
+{
+	if(entry->wd < 0) return;
+
+	for(const WatchEntry* it = watcher->entries, *end = it + watcher->count; it < end; it++)
+		if(it != entry && it->wd == entry->wd)
+			return;
+
+	inotify_rm_watch(watcher->fd, entry->wd);
+}
+
+static void readNotifications(FileWatcher* watcher)
+{
+	char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+	for(;;)
+	{
+		ssize_t size = read(watcher->fd, buffer, sizeof buffer);
+
+		if(size <= 0) break;
+
+		for(char* ptr = buffer; ptr < buffer + size;)
+		{
+			const struct inotify_event* event = (const struct inotify_event*)ptr;
+
+			for(WatchEntry* it = watcher->entries, *end = it + watcher->count; it < end; it++)
+				if(it->wd == event->wd && event->len && strcmp(event->name, getWatchName(it->path)) == 0)
+					it->pending = true;
+
+			ptr += sizeof(struct inotify_event) + event->len;
+		}
+	}
+}
+
+#endif
+
+void fsWatch(FileWatcher* watcher, const char* path, s32 id)
+{
+	WatchEntry* entry = getWatchEntry(watcher, id);
+
+	if(!entry)
+	{
+		if(watcher->count == WATCHER_ENTRIES) return;
+
+		entry = &watcher->entries[watcher->count++];
+	}
+#if defined(WATCHER_INOTIFY)
+	else removeDirWatch(watcher, entry);
+#endif
+
+	*entry = (WatchEntry)
+	{
+		.id = id,
+		.mdate = getMDate(path),
+		.pending = false,
+	};
+
+	strncpy(entry->path, path, sizeof entry->path - 1);
+
+#if defined(WATCHER_INOTIFY)
+	entry->wd = addDirWatch(watcher, entry->path);
+#endif
+}
+
+void fsWatchFile(FileSystem* fs, FileWatcher* watcher, const char* name, s32 id)
+{
+	fsWatch(watcher, getFilePath(fs, name), id);
+}
+
+void fsUnwatch(FileWatcher* watcher, s32 id)
+{
+	WatchEntry* entry = getWatchEntry(watcher, id);
+
+	if(entry)
+	{
+#if defined(WATCHER_INOTIFY)
+		removeDirWatch(watcher, entry);
+#endif
+		*entry = watcher->entries[--watcher->count];
+	}
+}
+
+bool fsWatcherEvent(FileWatcher* watcher, s32* id)
+{
+#if defined(WATCHER_INOTIFY)
+	if(watcher->fd >= 0)
+		readNotifications(watcher);
+#endif
+
+	if(++watcher->ticks >= WATCHER_POLL_PERIOD)
+	{
+		watcher->ticks = 0;
+
+		for(WatchEntry* it = watcher->entries, *end = it + watcher->count; it < end; it++)
+		{
+#if defined(WATCHER_INOTIFY)
+			if(it->wd >= 0) continue;
+#endif
+			u64 mdate = getMDate(it->path);
+
+			if(mdate != it->mdate)
+			{
+				it->mdate = mdate;
+				it->pending = true;
+			}
+		}
+	}
+
+	for(WatchEntry* it = watcher->entries, *end = it + watcher->count; it < end; it++)
+	{
+		if(it->pending)
+		{
+			it->pending = false;
+			*id = it->id;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void fsFreeWatcher(FileWatcher* watcher)
+{
+#if defined(WATCHER_INOTIFY)
+	if(watcher->fd >= 0)
+		close(watcher->fd);
+#endif
+
+	free(watcher);
+}
+
 bool fsSaveFile(FileSystem* fs, const char* name, const void* data, size_t size, bool overwrite)
 {
 	if(!overwrite)
@@ -1050,8 +1436,73 @@ bool fsSaveRootFile(FileSystem* fs, const char* name, const void* data, size_t s
 
 typedef struct
 {
-	const char* name;
+	FileSystem* fs;
+	char cachePath[FILENAME_MAX];
+	LoadCallback callback;
+	void* data;
+
+} LoadByHashData;
+
+static void onLoadByHashDone(const HttpGetData* data)
+{
+	LoadByHashData* loadByHashData = (LoadByHashData*)data->calldata;
+
+	if(data->status != HttpGetCancel)
+	{
+		if(data->status == HttpGetDone)
+		{
+			fsSaveRootFile(loadByHashData->fs, loadByHashData->cachePath, data->data, data->size, false);
+			loadByHashData->callback(data->data, data->size, loadByHashData->data);
+		}
+		else loadByHashData->callback(NULL, 0, loadByHashData->data);
+	}
+
+	free(loadByHashData);
+}
+
+void fsLoadFileByHashAsync(FileSystem* fs, const char* hash, LoadCallback callback, void* data)
+{
+#if defined(BAREMETALPI)
+	// TODO BAREMETALPI
+	callback(NULL, 0, data);
+#else
+	char cachePath[FILENAME_MAX] = {0};
+	sprintf(cachePath, TIC_CACHE "%s.tic", hash);
+
+	{
+		s32 size = 0;
+		void* buffer = fsLoadRootFile(fs, cachePath, &size);
+
+		if(buffer)
+		{
+			callback(buffer, size, data);
+			free(buffer);
+			return;
+		}
+	}
+
+	LoadByHashData* loadByHashData = (LoadByHashData*)malloc(sizeof(LoadByHashData));
+
+	if(loadByHashData)
+	{
+		*loadByHashData = (LoadByHashData){fs, {0}, callback, data};
+		strcpy(loadByHashData->cachePath, cachePath);
+
+		char path[FILENAME_MAX] = {0};
+		sprintf(path, "/cart/%s/cart.tic", hash);
+		studioHttpGet(path, onLoadByHashDone, loadByHashData);
+	}
+	else callback(NULL, 0, data);
+#endif
+}
+
+typedef struct
+{
+	FileSystem* fs;
+	char name[FILENAME_MAX];
 	char hash[FILENAME_MAX];
+	LoadCallback callback;
+	void* data;
 
 } LoadPublicCartData;
 
@@ -1068,29 +1519,46 @@ static bool onLoadPublicCart(const char* name, const char* info, s32 id, void* d
 	return true;
 }
 
-void* fsLoadFileByHash(FileSystem* fs, const char* hash, s32* size)
+static void onLoadPublicCartDone(void* data)
 {
-#if defined(BAREMETALPI)
-	// TODO BAREMETALPI
-	return NULL;
-#else
-	char cachePath[FILENAME_MAX] = {0};
-	sprintf(cachePath, TIC_CACHE "%s.tic", hash);
+	LoadPublicCartData* loadPublicCartData = (LoadPublicCartData*)data;
+
+	if(strlen(loadPublicCartData->hash))
+		fsLoadFileByHashAsync(loadPublicCartData->fs, loadPublicCartData->hash, loadPublicCartData->callback, loadPublicCartData->data);
+	else loadPublicCartData->callback(NULL, 0, loadPublicCartData->data);
+
+	free(loadPublicCartData);
+}
 
+void fsLoadFileAsync(FileSystem* fs, const char* name, LoadCallback callback, void* data)
+{
+	if(isPublic(fs))
 	{
-		void* data = fsLoadRootFile(fs, cachePath, size);
-		if(data) return data;
+		LoadPublicCartData* loadPublicCartData = (LoadPublicCartData*)malloc(sizeof(LoadPublicCartData));
+
+		if(loadPublicCartData && strlen(name) < FILENAME_MAX)
+		{
+			*loadPublicCartData = (LoadPublicCartData){.fs = fs, .callback = callback, .data = data};
+			strcpy(loadPublicCartData->name, name);
+
+			fsEnumFilesAsync(fs, onLoadPublicCart, onLoadPublicCartDone, loadPublicCartData);
+		}
+		else
+		{
+			free(loadPublicCartData);
+			callback(NULL, 0, data);
+		}
+
+		return;
 	}
 
-	char path[FILENAME_MAX] = {0};
-	sprintf(path, "/cart/%s/cart.tic", hash);
-	void* data = getSystem()->getUrlRequest(path, size);
+	s32 size = 0;
+	void* buffer = fsLoadFile(fs, name, &size);
 
-	if(data)
-		fsSaveRootFile(fs, cachePath, data, *size, false);
+	callback(buffer, size, data);
 
-	return data;
-#endif
+	if(buffer)
+		free(buffer);
 }
 
 void* fsLoadFile(FileSystem* fs, const char* name, s32* size)
@@ -1149,20 +1617,8 @@ void* fsLoadFile(FileSystem* fs, const char* name, s32* size)
 	}
 	return NULL;
 #else
-	if(isPublic(fs))
-	{
-		LoadPublicCartData loadPublicCartData = 
-		{
-			.name = name,
-			.hash = {0},
-		};
-
-		fsEnumFiles(fs, onLoadPublicCart, &loadPublicCartData);
-
-		if(strlen(loadPublicCartData.hash))
-			return fsLoadFileByHash(fs, loadPublicCartData.hash, size);
-	}
-	else
+	// public carts are only loaded by fsLoadFileAsync
+	if(!isPublic(fs))
 	{
 		const fsString* pathString = utf8ToString(getFilePath(fs, name));
 		FILE* file = tic_fopen(pathString, _S("rb"));
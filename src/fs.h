@@ -42,12 +42,19 @@ typedef bool(*ListCallback)(const char* name, const char* info, s32 id, void* da
 typedef void(*AddCallback)(const char*, AddResult, void*);
 typedef void(*GetCallback)(GetResult, void*);
 typedef void(*OpenCallback)(const char* name, const void* buffer, size_t size, void* data);
+typedef void(*DoneCallback)(void* data);
+typedef void(*LoadCallback)(const void* buffer, s32 size, void* data);
+typedef void(*IsDirCallback)(bool dir, void* data);
 
 typedef struct FileSystem FileSystem;
+typedef struct FileWatcher FileWatcher;
 
 FileSystem* createFileSystem(const char* path);
 
+// the blocking calls only see local folders, public ones are fetched by the async calls,
+// whose callbacks are dropped if the studio closes with the request pending
 void fsEnumFiles(FileSystem* fs, ListCallback callback, void* data);
+void fsEnumFilesAsync(FileSystem* fs, ListCallback callback, DoneCallback done, void* data);
 void fsAddFile(FileSystem* fs, AddCallback callback, void* data);
 void fsGetFile(FileSystem* fs, GetCallback callback, const char* name, void* data);
 bool fsDeleteFile(FileSystem* fs, const char* name);
@@ -55,24 +62,37 @@ bool fsDeleteDir(FileSystem* fs, const char* name);
 bool fsSaveFile(FileSystem* fs, const char* name, const void* data, size_t size, bool overwrite);
 bool fsSaveRootFile(FileSystem* fs, const char* name, const void* data, size_t size, bool overwrite);
 void* fsLoadFile(FileSystem* fs, const char* name, s32* size);
-void* fsLoadFileByHash(FileSystem* fs, const char* hash, s32* size);
+void fsLoadFileAsync(FileSystem* fs, const char* name, LoadCallback callback, void* data);
+void fsLoadFileByHashAsync(FileSystem* fs, const char* hash, LoadCallback callback, void* data);
 void* fsLoadRootFile(FileSystem* fs, const char* name, s32* size);
+void fsGetRootFilePath(FileSystem* fs, const char* name, char* out);
 void fsMakeDir(FileSystem* fs, const char* name);
 bool fsExistsFile(FileSystem* fs, const char* name);
 u64 fsMDate(FileSystem* fs, const char* name);
 
+FileWatcher* fsCreateWatcher();
+void fsWatch(FileWatcher* watcher, const char* path, s32 id);
+void fsWatchFile(FileSystem* fs, FileWatcher* watcher, const char* name, s32 id);
+void fsUnwatch(FileWatcher* watcher, s32 id);
+bool fsWatcherEvent(FileWatcher* watcher, s32* id);
+void fsFreeWatcher(FileWatcher* watcher);
+
 void fsBasename(const char *path, char* out);
 void fsFilename(const char *path, char* out);
 bool fsExists(const char* name);
 void* fsReadFile(const char* path, s32* size);
+bool fsReadFileRange(const char* path, s32 offset, void* buffer, s32 size);
 bool fsWriteFile(const char* path, const void* data, s32 size);
+bool fsWriteFileAtomic(const char* path, const void* data, s32 size);
 bool fsCopyFile(const char* src, const char* dst);
 void fsGetFileData(GetCallback callback, const char* name, void* buffer, size_t size, u32 mode, void* data);
 void fsOpenFileData(OpenCallback callback, void* data);
 void fsOpenWorkingFolder(FileSystem* fs);
 bool fsIsDir(FileSystem* fs, const char* dir);
+void fsIsDirAsync(FileSystem* fs, const char* dir, IsDirCallback callback, void* data);
 bool fsIsInPublicDir(FileSystem* fs);
 bool fsChangeDir(FileSystem* fs, const char* dir);
+void fsChangeDirAsync(FileSystem* fs, const char* dir, IsDirCallback callback, void* data);
 void fsGetDir(FileSystem* fs, char* out);
 void fsDirBack(FileSystem* fs);
 void fsHomeDir(FileSystem* fs);
\ No newline at end of file
@@ -26,11 +26,15 @@
 #include <stdio.h>
 #include <string.h>
 
+// an entry either XORs `removed` bytes at `offset` or, for splices, replaces
+// `removed` bytes at `offset` with `inserted` ones and shifts the rest of the buffer
 typedef struct
 {
 	u8* buffer;
-	u32 start;
-	u32 end;
+	u32 offset;
+	u32 removed;
+	u32 inserted;
+	bool splice;
 } Data;
 
 typedef struct Item Item;
@@ -43,37 +47,45 @@ struct Item
 	Data data;
 };
 
-static void list_delete(Item* list, Item* from)
+struct History
 {
-	Item* it = from;
+	Item* list;
 
-	while(it)
-	{
-		Item* next = it->next;
+	u32 size;
+	u8* state;
+
+	void* data;
 
-		if(it->data.buffer) free(it->data.buffer);
-		if(it) free(it);
+	u32 used;
+	u32 budget;
+	bool merge;
 
-		it = next;
-	}
+	u32 generation;
+};
+
+// shared by all histories so a recreated history never repeats a generation
+static u32 Generation = 0;
+
+static inline u32 data_size(const Data* data)
+{
+	return sizeof(Item) + (data->splice ? data->removed + data->inserted : data->removed);
 }
 
-static Item* list_insert(Item* list, Data* data)
+static void list_delete(History* history, Item* from)
 {
-	Item* item = (Item*)malloc(sizeof(Item));
-	item->next = NULL;
-	item->prev = NULL;
-	item->data = *data;
+	Item* it = from;
 
-	if(list)
+	while(it)
 	{
-		list_delete(list, list->next);
+		Item* next = it->next;
 
-		list->next = item;
-		item->prev = list;
-	}
+		history->used -= data_size(&it->data);
+
+		free(it->data.buffer);
+		free(it);
 
-	return item;
+		it = next;
+	}
 }
 
 static Item* list_first(Item* list)
@@ -84,15 +96,49 @@ static Item* list_first(Item* list)
 	return it;
 }
 
-struct History
+static void history_evict(History* history)
 {
-	Item* list;
+	// drop the oldest steps, the first item only marks the bottom of the undo stack
+	while(history->budget && history->used > history->budget)
+	{
+		Item* first = list_first(history->list);
+		Item* second = first->next;
 
-	u32 size;
-	u8* state;
+		if(first == history->list) break;
 
-	void* data;
-};
+		history->used -= data_size(&first->data) + data_size(&second->data);
+
+		free(first->data.buffer);
+		free(first);
+		free(second->data.buffer);
+
+		second->prev = NULL;
+		second->data = (Data){NULL};
+
+		history->used += data_size(&second->data);
+	}
+}
+
+static void list_insert(History* history, const Data* data)
+{
+	Item* item = (Item*)malloc(sizeof(Item));
+	item->next = NULL;
+	item->prev = NULL;
+	item->data = *data;
+
+	if(history->list)
+	{
+		list_delete(history, history->list->next);
+
+		history->list->next = item;
+		item->prev = history->list;
+	}
+
+	history->list = item;
+	history->used += data_size(data);
+
+	history_evict(history);
+}
 
 History* history_create(void* data, u32 size)
 {
@@ -101,12 +147,16 @@ History* history_create(void* data, u32 size)
 
 	history->list = NULL;
 	history->size = size;
+	history->used = 0;
+	history->budget = 0;
+	history->merge = false;
+	history->generation = ++Generation;
 
 	history->state = malloc(size);
 	memcpy(history->state, data, history->size);
 
 	// empty diff
-	history->list = list_insert(history->list, &(Data){NULL, 0, 0});
+	list_insert(history, &(Data){NULL});
 
 	return history;
 }
@@ -117,77 +167,182 @@ void history_delete(History* history)
 	{
 		free(history->state);
 
-		list_delete(history->list, list_first(history->list));
+		list_delete(history, list_first(history->list));
 
 		free(history);
 	}
 }
 
-static void history_diff(History* history, Data* data)
+void history_budget(History* history, u32 size)
 {
-	for (u32 i = data->start, k = 0; i < data->end; ++i, ++k)
-		history->state[i] ^= data->buffer[k];
+	history->budget = size;
+	history_evict(history);
 }
 
-static u32 trim_left(u8* data, u32 size)
+static void splice(u8* dst, u32 size, u32 offset, u32 removed, const u8* bytes, u32 inserted)
 {
-	for(u32 i = 0; i < size; i++)
-		if(data[i]) return i;
+	memmove(dst + offset + inserted, dst + offset + removed, size - offset - (removed > inserted ? removed : inserted));
+	memcpy(dst + offset, bytes, inserted);
 
-	return size;
+	if(removed > inserted)
+		memset(dst + size - (removed - inserted), 0, removed - inserted);
 }
 
-static u32 trim_right(u8* data, u32 size)
+static u32 history_apply(History* history, const Data* data, bool forward)
 {
-	for(u32 i = 0; i < size; i++)
-		if(data[size - i - 1]) return size - i;
+	if(data->splice)
+	{
+		const u8* removed = data->buffer;
+		const u8* inserted = data->buffer + data->removed;
+
+		if(forward)
+			splice(history->state, history->size, data->offset, data->removed, inserted, data->inserted);
+		else
+			splice(history->state, history->size, data->offset, data->inserted, removed, data->removed);
+
+		return data->offset + (forward ? data->inserted : data->removed);
+	}
 
-	return 0;
+	for(u32 i = 0; i < data->removed; i++)
+		history->state[data->offset + i] ^= data->buffer[i];
+
+	return data->offset + data->removed;
 }
 
 bool history_add(History* history)
 {
-	if (memcmp(history->state, history->data, history->size) == 0) return false;
+	const u8* data = history->data;
+	u32 start = 0, end = history->size;
+
+	while(start < end && history->state[start] == data[start]) start++;
+
+	if(start == end) return false;
+
+	while(history->state[end - 1] == data[end - 1]) end--;
+
+	Data diff = {malloc(end - start), start, end - start, end - start, false};
+
+	for(u32 i = start; i < end; i++)
+		diff.buffer[i - start] = history->state[i] ^ data[i];
+
+	memcpy(history->state + start, data + start, end - start);
+
+	history->merge = false;
+	history->generation = ++Generation;
+	list_insert(history, &diff);
+
+	return true;
+}
+
+static bool history_merge(History* history, u32 offset, const u8* removed, u32 removedSize, const u8* inserted, u32 insertedSize)
+{
+	Data* last = &history->list->data;
 
-	history_diff(history, &(Data){history->data, 0, history->size});
+	if(!history->merge || !last->splice)
+		return false;
 
+	if(!removedSize && !last->removed && offset == last->offset + last->inserted)
 	{
-		Data data;
-		data.start = trim_left(history->state, history->size);
-		data.end = trim_right(history->state, history->size);
-		u32 size = data.end - data.start;
-		data.buffer = malloc(size);
+		u8* buffer = realloc(last->buffer, last->inserted + insertedSize);
 
-		memcpy(data.buffer, (u8*)history->state + data.start, size);
+		// keep the old step, the edit gets a step of its own
+		if(!buffer) return false;
 
-		history->list = list_insert(history->list, &data);
+		last->buffer = buffer;
+		memcpy(last->buffer + last->inserted, inserted, insertedSize);
+		last->inserted += insertedSize;
+	}
+	else if(!insertedSize && !last->inserted && (offset + removedSize == last->offset || offset == last->offset))
+	{
+		u8* buffer = malloc(last->removed + removedSize);
+
+		if(!buffer) return false;
+
+		if(offset == last->offset)
+		{
+			memcpy(buffer, last->buffer, last->removed);
+			memcpy(buffer + last->removed, removed, removedSize);
+		}
+		else
+		{
+			memcpy(buffer, removed, removedSize);
+			memcpy(buffer + removedSize, last->buffer, last->removed);
+		}
+
+		free(last->buffer);
+		last->buffer = buffer;
+		last->offset = offset;
+		last->removed += removedSize;
 	}
+	else return false;
 
-	memcpy(history->state, history->data, history->size);
+	history->used += removedSize + insertedSize;
+	history_evict(history);
 
 	return true;
 }
 
-void history_undo(History* history)
+bool history_replace(History* history, u32 offset, const void* removed, u32 removedSize, u32 insertedSize, bool merge)
+{
+	const u8* inserted = (const u8*)history->data + offset;
+
+	splice(history->state, history->size, offset, removedSize, inserted, insertedSize);
+
+	bool merged = merge && history_merge(history, offset, removed, removedSize, inserted, insertedSize);
+
+	if(!merged)
+	{
+		Data data = {malloc(removedSize + insertedSize), offset, removedSize, insertedSize, true};
+
+		memcpy(data.buffer, removed, removedSize);
+		memcpy(data.buffer + removedSize, inserted, insertedSize);
+
+		list_insert(history, &data);
+	}
+
+	history->merge = merge;
+	history->generation = ++Generation;
+
+	return !merged;
+}
+
+s32 history_undo(History* history)
 {
+	s32 pos = -1;
+
 	if(history->list->prev)
 	{
-		history_diff(history, &history->list->data);
+		pos = history_apply(history, &history->list->data, false);
 
 		history->list = history->list->prev;
 	}
 
+	history->merge = false;
+	history->generation = ++Generation;
 	memcpy(history->data, history->state, history->size);
+
+	return pos;
 }
 
-void history_redo(History* history)
+s32 history_redo(History* history)
 {
+	s32 pos = -1;
+
 	if(history->list->next)
 	{
 		history->list = history->list->next;
 
-		history_diff(history, &history->list->data);
+		pos = history_apply(history, &history->list->data, true);
 	}
 
+	history->merge = false;
+	history->generation = ++Generation;
 	memcpy(history->data, history->state, history->size);
+
+	return pos;
 }
+
+u32 history_generation(History* history)
+{
+	return history->generation;
+}
\ No newline at end of file
@@ -28,6 +28,19 @@ typedef struct History History;
 
 History* history_create(void* data, u32 size);
 bool history_add(History* history);
-void history_undo(History* history);
-void history_redo(History* history);
+
+// records an edit already applied to the data: `removed` bytes at `offset` were replaced
+// with `insertedSize` bytes and the rest of the buffer shifted, `merge` lets a contiguous
+// insert or delete join the previous step
+bool history_replace(History* history, u32 offset, const void* removed, u32 removedSize, u32 insertedSize, bool merge);
+
+// undo/redo return the end of the changed range or -1 when there is no step to apply
+s32 history_undo(History* history);
+s32 history_redo(History* history);
+
+// oldest steps are dropped once the recorded steps take more than `size` bytes, 0 is unlimited
+void history_budget(History* history, u32 size);
+
+// changes on every recorded step, undo and redo
+u32 history_generation(History* history);
 void history_delete(History* history);
\ No newline at end of file
@@ -72,6 +72,20 @@ static duk_ret_t duk_print(duk_context* duk)
 	return 1;
 }
 
+static duk_ret_t duk_textwidth(duk_context* duk)
+{
+	tic_mem* memory = (tic_mem*)getDukMachine(duk);
+
+	const char* text = duk_is_null_or_undefined(duk, 0) ? "" : duk_to_string(duk, 0);
+	bool fixed = duk_is_null_or_undefined(duk, 1) ? false : duk_to_boolean(duk, 1);
+	s32 scale = duk_is_null_or_undefined(duk, 2) ? 1 : duk_to_int(duk, 2);
+	bool alt = duk_is_null_or_undefined(duk, 3) ? false : duk_to_boolean(duk, 3);
+
+	duk_push_uint(duk, memory->api.text_width(memory, text ? text : "nil", fixed, scale, alt));
+
+	return 1;
+}
+
 static duk_ret_t duk_cls(duk_context* duk)
 {
 	tic_mem* memory = (tic_mem*)getDukMachine(duk);
@@ -822,6 +836,7 @@ static const struct{duk_c_function func; s32 params;} ApiFunc[] =
 	{duk_reset, 0},
 	{duk_key, 1},
 	{duk_keyp, 3},
+	{duk_textwidth, 4},
 };
 
 STATIC_ASSERT(api_func, COUNT_OF(ApiKeywords) == COUNT_OF(ApiFunc));
@@ -1039,6 +1039,43 @@ static s32 lua_print(lua_State* lua)
 	return 0;
 }
 
+static s32 lua_textwidth(lua_State* lua)
+{
+	s32 top = lua_gettop(lua);
+
+	if(top >= 1) 
+	{
+		tic_mem* memory = (tic_mem*)getLuaMachine(lua);
+
+		bool fixed = false;
+		s32 scale = 1;
+		bool alt = false;
+
+		const char* text = printString(lua, 1);
+
+		if(top >= 2)
+		{
+			fixed = lua_toboolean(lua, 2);
+
+			if(top >= 3)
+			{
+				scale = getLuaNumber(lua, 3);
+
+				if(top >= 4)
+				{
+					alt = lua_toboolean(lua, 4);
+				}
+			}
+		}
+
+		lua_pushinteger(lua, memory->api.text_width(memory, text ? text : "nil", fixed, scale, alt));
+
+		return 1;
+	}
+
+	return 0;
+}
+
 static s32 lua_trace(lua_State *lua)
 {
 	s32 top = lua_gettop(lua);
@@ -1170,7 +1207,7 @@ static const lua_CFunction ApiFunc[] =
 	lua_mset, lua_peek, lua_poke, lua_peek4, lua_poke4, lua_memcpy, 
 	lua_memset, lua_trace, lua_pmem, lua_time, lua_exit, lua_font, lua_mouse, 
 	lua_circ, lua_circb, lua_tri, lua_textri, lua_clip, lua_music, lua_sync, lua_reset,
-	lua_key, lua_keyp
+	lua_key, lua_keyp, lua_textwidth
 };
 
 STATIC_ASSERT(api_func, COUNT_OF(ApiKeywords) == COUNT_OF(ApiFunc));
@@ -1185,6 +1222,53 @@ static void checkForceExit(lua_State *lua, lua_Debug *luadebug)
 		luaL_error(lua, "script execution was interrupted");
 }
 
+static void sampleProfile(lua_State* lua, tic_profile* profile)
+{
+	lua_Debug ar;
+
+	profile->samples++;
+
+	// the first frame from the cart code gets the sample, dofile chunks are '@' sources
+	for(s32 level = 0; lua_getstack(lua, level, &ar); level++)
+	{
+		lua_getinfo(lua, "Sl", &ar);
+
+		if(ar.currentline > 0 && *ar.source != '@' && *ar.source != '=')
+		{
+			if(ar.currentline <= COUNT_OF(profile->lines))
+				profile->lines[ar.currentline - 1]++;
+
+			if(ar.linedefined > 0 && ar.linedefined <= COUNT_OF(profile->functions))
+				profile->functions[ar.linedefined - 1]++;
+
+			break;
+		}
+	}
+}
+
+static void profileHook(lua_State *lua, lua_Debug *luadebug)
+{
+	tic_profile* profile = getLuaMachine(lua)->data->profile;
+
+	// `profile off` while the game was paused, back to the plain exit check
+	if(!profile->period)
+	{
+		lua_sethook(lua, &checkForceExit, LUA_MASKCOUNT, LUA_LOC_STACK);
+		checkForceExit(lua, luadebug);
+		return;
+	}
+
+	// the period could be changed while paused as well
+	if((u32)lua_gethookcount(lua) != profile->period)
+		lua_sethook(lua, &profileHook, LUA_MASKCOUNT, profile->period);
+
+	sampleProfile(lua, profile);
+
+	// keep checking for exit as often as the default hook does
+	if(profile->samples % MAX(1, (u32)(LUA_LOC_STACK / profile->period)) == 0)
+		checkForceExit(lua, luadebug);
+}
+
 static void initAPI(tic_machine* machine)
 {
 	CurrentMachine = machine;
@@ -1222,6 +1306,9 @@ static bool initLua(tic_mem* tic, const char* code)
 
 	initAPI(machine);
 
+	if(machine->data->profile)
+		lua_sethook(lua, &profileHook, LUA_MASKCOUNT, machine->data->profile->period);
+
 	{
 		lua_State* lua = machine->lua;
 
@@ -35,7 +35,7 @@
 #define API_KEYWORDS {TIC_FN, SCN_FN, OVR_FN, "print", "cls", "pix", "line", "rect", "rectb", \
 	"spr", "btn", "btnp", "sfx", "map", "mget", "mset", "peek", "poke", "peek4", "poke4", \
 	"memcpy", "memset", "trace", "pmem", "time", "exit", "font", "mouse", "circ", "circb", "tri", "textri", \
-	"clip", "music", "sync", "reset", "key", "keyp"}
+	"clip", "music", "sync", "reset", "key", "keyp", "textwidth"}
 	
 typedef struct
 {
@@ -163,6 +163,31 @@ typedef struct
 	bool initialized;
 } tic_machine_state_data;
 
+// a font glyph as horizontal runs of set pixels per row, `start` and `end` bound the used columns
+typedef struct
+{
+	u8 source[TIC_FONT_HEIGHT];
+	bool ready;
+	u8 start;
+	u8 end;
+	u8 count[TIC_FONT_HEIGHT];
+
+	struct
+	{
+		u8 x;
+		u8 w;
+	} spans[TIC_FONT_HEIGHT][BITS_IN_BYTE / 2];
+} tic_glyph;
+
+typedef struct
+{
+	tic_tile source;
+	u8 chromakey;
+	bool ready;
+	u8 start;
+	u8 end;
+} tic_sprite_glyph;
+
 typedef struct
 {
 	tic_mem memory; // it should be first
@@ -200,12 +225,27 @@ typedef struct
 	{
 		const tic_sfx* sfx;
 		const tic_music* music;
+
+		// set for frames nobody hears, the sound state still advances
+		bool skip;
 	} sound;
 
 	tic_tick_data* data;
 
 	tic_machine_state_data state;
 
+	// rebuilt lazily whenever the font bytes behind a glyph change,
+	// alt font symbols share bytes with regular ones but are cut at a different width
+	struct
+	{
+		tic_glyph font[TIC_FONT_CHARS];
+		tic_glyph altfont[TIC_FONT_CHARS];
+		tic_sprite_glyph sprites[TIC_BANK_SPRITES];
+	} glyphs;
+
+	// cart banks ever loaded, cleared or synced to, they stay resident even when empty
+	u8 resident;
+
 	struct
 	{
 		tic_machine_state_data state;	
@@ -224,7 +264,7 @@ typedef s32(DrawCharFunc)(tic_mem* memory, u8 symbol, s32 x, s32 y, s32 width, s
 s32 drawText(tic_mem* memory, const char* text, s32 x, s32 y, s32 width, s32 height, u8 color, s32 scale, DrawCharFunc* func, bool alt);
 s32 drawSpriteFont(tic_mem* memory, u8 symbol, s32 x, s32 y, s32 width, s32 height, u8 chromakey, s32 scale, bool alt);
 s32 drawFixedSpriteFont(tic_mem* memory, u8 index, s32 x, s32 y, s32 width, s32 height, u8 chromakey, s32 scale, bool alt);
-void parseCode(const tic_script_config* config, const char* start, u8* color, const tic_code_theme* theme);
+tic_parse_state parseCode(const tic_script_config* config, const char* line, u8* color, const tic_code_theme* theme, tic_parse_state state);
 
 #if defined(TIC_BUILD_WITH_SQUIRREL)
 const tic_script_config* getSquirrelScriptConfig();
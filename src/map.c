@@ -22,6 +22,7 @@
 
 #include "map.h"
 #include "history.h"
+#include "fill.h"
 
 #define SHEET_COLS (TIC_SPRITESHEET_SIZE / TIC_SPRITESIZE)
 
@@ -37,7 +38,6 @@
 
 #define MIN_SCALE 1
 #define MAX_SCALE 4
-#define FILL_STACK_SIZE (TIC_MAP_WIDTH*TIC_MAP_HEIGHT)
 
 static void normalizeMap(s32* x, s32* y)
 {
@@ -47,6 +47,56 @@ static void normalizeMap(s32* x, s32* y)
 	while(*y >= MAX_SCROLL_Y) *y -= MAX_SCROLL_Y;
 }
 
+static void normalizeMapRect(s32* x, s32* y)
+{
+	while(*x < 0) *x += TIC_MAP_WIDTH;
+	while(*y < 0) *y += TIC_MAP_HEIGHT;
+	while(*x >= TIC_MAP_WIDTH) *x -= TIC_MAP_WIDTH;
+	while(*y >= TIC_MAP_HEIGHT) *y -= TIC_MAP_HEIGHT;
+}
+
+static void getMapRect(Map* map, const tic_rect* rect, u8* buffer)
+{
+	for(s32 j = 0; j < rect->h; j++)
+		for(s32 i = 0; i < rect->w;)
+		{
+			s32 x = rect->x + i, y = rect->y + j;
+			normalizeMapRect(&x, &y);
+
+			s32 size = MIN(rect->w - i, TIC_MAP_WIDTH - x);
+			memcpy(buffer + i + j * rect->w, map->src->data + x + y * TIC_MAP_WIDTH, size);
+			i += size;
+		}
+}
+
+static void setMapRect(Map* map, const tic_rect* rect, const u8* buffer)
+{
+	for(s32 j = 0; j < rect->h; j++)
+		for(s32 i = 0; i < rect->w;)
+		{
+			s32 x = rect->x + i, y = rect->y + j;
+			normalizeMapRect(&x, &y);
+
+			s32 size = MIN(rect->w - i, TIC_MAP_WIDTH - x);
+			memcpy(map->src->data + x + y * TIC_MAP_WIDTH, buffer + i + j * rect->w, size);
+			i += size;
+		}
+}
+
+static void fillMapRect(Map* map, const tic_rect* rect, u8 tile)
+{
+	for(s32 j = 0; j < rect->h; j++)
+		for(s32 i = 0; i < rect->w;)
+		{
+			s32 x = rect->x + i, y = rect->y + j;
+			normalizeMapRect(&x, &y);
+
+			s32 size = MIN(rect->w - i, TIC_MAP_WIDTH - x);
+			memset(map->src->data + x + y * TIC_MAP_WIDTH, tile, size);
+			i += size;
+		}
+}
+
 static tic_point getTileOffset(Map* map)
 {
 	return (tic_point){(map->sheet.rect.w - 1)*TIC_SPRITESIZE / 2, (map->sheet.rect.h - 1)*TIC_SPRITESIZE / 2};
@@ -424,7 +474,7 @@ static void drawCursorPos(Map* map, s32 x, s32 y)
 
 	sprintf(pos, "%03i:%03i", tx, ty);
 
-	s32 width = map->tic->api.text(map->tic, pos, TIC80_WIDTH, 0, tic_color_7, false);
+	s32 width = map->tic->api.text_width(map->tic, pos, false, 1, false);
 
 	s32 px = x + (TIC_SPRITESIZE + 3);
 	if(px + width >= TIC80_WIDTH) px = x - (width + 2);
@@ -597,10 +647,7 @@ static void drawPasteData(Map* map)
 		mx /= TIC_SPRITESIZE;
 		my /= TIC_SPRITESIZE;
 
-		for(s32 j = 0; j < h; j++)
-			for(s32 i = 0; i < w; i++)
-				map->tic->api.map_set(map->tic, map->src, (mx+i)%TIC_MAP_WIDTH, (my+j)%TIC_MAP_HEIGHT, data[i + j * w]);
-
+		setMapRect(map, &(tic_rect){mx, my, w, h}, data);
 		history_add(map->history);
 
 		free(map->paste);
@@ -622,14 +669,6 @@ static void drawPasteData(Map* map)
 	}
 }
 
-static void normalizeMapRect(s32* x, s32* y)
-{
-	while(*x < 0) *x += TIC_MAP_WIDTH;
-	while(*y < 0) *y += TIC_MAP_HEIGHT;
-	while(*x >= TIC_MAP_WIDTH) *x -= TIC_MAP_WIDTH;
-	while(*y >= TIC_MAP_HEIGHT) *y -= TIC_MAP_HEIGHT;
-}
-
 static void processMouseSelectMode(Map* map)
 {
 	tic_rect rect = {MAP_X, MAP_Y, MAP_WIDTH, MAP_HEIGHT};
@@ -677,119 +716,102 @@ static void processMouseSelectMode(Map* map)
 
 typedef struct
 {
-	tic_point* data;
-	tic_point* head;
-} FillStack;
+	Map* map;
+	tic_point start;
+	u8 tile;
+} MapFill;
 
-static bool push(FillStack* stack, s32 x, s32 y)
+static tic_rect getFillClip(Map* map)
 {
-	if(stack->head == NULL)
-	{
-		stack->head = stack->data;
-		stack->head->x = x;
-		stack->head->y = y;
+	tic_rect clip = {0, 0, TIC_MAP_WIDTH, TIC_MAP_HEIGHT};
 
-		return true;
-	}
-
-	if(stack->head < (stack->data + FILL_STACK_SIZE-1))
-	{		
-		stack->head++;
-		stack->head->x = x;
-		stack->head->y = y;
-
-		return true;
+	if(map->select.rect.w > 0 && map->select.rect.h > 0)
+	{
+		clip = map->select.rect;
+		normalizeMapRect(&clip.x, &clip.y);
 	}
 
-	return false;
+	return clip;
 }
 
-static bool pop(FillStack* stack, s32* x, s32* y)
+// the fill walks a grid of stamp sized blocks aligned to the clicked cell,
+// the clicked block is always stamped and the ones around it have to be all `tile`
+static bool matchMapBlock(void* data, s32 x, s32 y)
 {
-	if(stack->head > stack->data)
-	{
-		*x = stack->head->x;
-		*y = stack->head->y;
-
-		stack->head--;
+	MapFill* fill = data;
+	Map* map = fill->map;
 
+	if(x == 0 && y == 0)
 		return true;
-	}
 
-	if(stack->head == stack->data)
-	{
-		*x = stack->head->x;
-		*y = stack->head->y;
+	x = fill->start.x + x * map->sheet.rect.w;
+	y = fill->start.y + y * map->sheet.rect.h;
+
+	for(s32 j = 0; j < map->sheet.rect.h; j++)
+		for(s32 i = 0; i < map->sheet.rect.w; i++)
+			if(map->tic->api.map_get(map->tic, map->src, x+i, y+j) != fill->tile)
+				return false;
 
-		stack->head = NULL;
+	return true;
+}
 
-		return true;
-	}
+static void fillMapBlocks(void* data, s32 x, s32 y, s32 width)
+{
+	MapFill* fill = data;
+	Map* map = fill->map;
 
-	return false;
+	s32 mx = map->sheet.rect.x;
+	s32 my = map->sheet.rect.y;
+	s32 w = map->sheet.rect.w;
+	s32 h = map->sheet.rect.h;
+
+	x = fill->start.x + x * w;
+	y = fill->start.y + y * h;
+
+	for(s32 j = 0; j < h; j++)
+		for(s32 i = 0; i < width * w; i++)
+			map->tic->api.map_set(map->tic, map->src, x+i, y+j, (mx+i%w) + (my+j) * SHEET_COLS);
 }
 
 static void fillMap(Map* map, s32 x, s32 y, u8 tile)
 {
 	if(tile == (map->sheet.rect.x + map->sheet.rect.y * SHEET_COLS)) return;
 
-	static FillStack stack = {NULL, NULL};
-
-	if(!stack.data)
-		stack.data = (tic_point*)malloc(FILL_STACK_SIZE * sizeof(tic_point));
+	tic_rect clip = getFillClip(map);
 
-	stack.head = NULL;
+	if(x < clip.x || x >= clip.x + clip.w || y < clip.y || y >= clip.y + clip.h) return;
 
-	static const s32 dx[4] = {0, 1, 0, -1};
-	static const s32 dy[4] = {-1, 0, 1, 0};
+	s32 w = map->sheet.rect.w;
+	s32 h = map->sheet.rect.h;
 
-	if(!push(&stack, x, y)) return;
+	// clip in blocks, a block only has to start inside the clip
+	s32 l = -((x - clip.x) / w);
+	s32 t = -((y - clip.y) / h);
+	s32 r = (clip.x + clip.w - 1 - x) / w;
+	s32 b = (clip.y + clip.h - 1 - y) / h;
 
-	s32 mx = map->sheet.rect.x;
-	s32 my = map->sheet.rect.y;
+	MapFill fill = {map, {x, y}, tile};
+	if(!flood_fill(&(tic_rect){l, t, r - l + 1, b - t + 1}, 0, 0, matchMapBlock, fillMapBlocks, &fill))
+		showPopupMessage("FILL STOPPED, OUT OF MEMORY :(");
+}
 
-	struct
-	{
-		s32 l;
-		s32 t;
-		s32 r;
-		s32 b;
-	}clip = { 0, 0, TIC_MAP_WIDTH, TIC_MAP_HEIGHT };
+static void replaceTile(Map* map, u8 tile)
+{
+	u8 fill = map->sheet.rect.x + map->sheet.rect.y * SHEET_COLS;
 
-	if (map->select.rect.w > 0 && map->select.rect.h > 0)
-	{
-		clip.l = map->select.rect.x;
-		clip.t = map->select.rect.y;
-		clip.r = map->select.rect.x + map->select.rect.w;
-		clip.b = map->select.rect.y + map->select.rect.h;
-	}
+	if(tile == fill) return;
 
-	while(pop(&stack, &x, &y))
-	{
-		for(s32 j = 0; j < map->sheet.rect.h; j++)
-			for(s32 i = 0; i < map->sheet.rect.w; i++)
-				map->tic->api.map_set(map->tic, map->src, x+i, y+j, (mx+i) + (my+j) * SHEET_COLS);
+	tic_rect clip = getFillClip(map);
 
-		for(s32 i = 0; i < COUNT_OF(dx); i++) 
+	for(s32 j = clip.y; j < clip.y + clip.h; j++)
+		for(s32 i = clip.x; i < clip.x + clip.w; i++)
 		{
-			s32 nx = x + dx[i]*map->sheet.rect.w;
-			s32 ny = y + dy[i]*map->sheet.rect.h;
-
-			if(nx >= clip.l && nx < clip.r && ny >= clip.t && ny < clip.b) 
-			{
-				bool match = true;
-				for(s32 j = 0; j < map->sheet.rect.h; j++)
-					for(s32 i = 0; i < map->sheet.rect.w; i++)
-						if(map->tic->api.map_get(map->tic, map->src, nx+i, ny+j) != tile)
-							match = false;
+			s32 x = i, y = j;
+			normalizeMapRect(&x, &y);
 
-				if(match)
-				{
-					if(!push(&stack, nx, ny)) return;
-				}
-			}
+			u8* cell = &map->src->data[x + y * TIC_MAP_WIDTH];
+			if(*cell == tile) *cell = fill;
 		}
-	}
 }
 
 static void processMouseFillMode(Map* map)
@@ -805,7 +827,12 @@ static void processMouseFillMode(Map* map)
 		s32 tx = 0, ty = 0;
 		getMouseMap(map, &tx, &ty);
 
-		fillMap(map, tx, ty, map->tic->api.map_get(map->tic, map->src, tx, ty));
+		u8 tile = map->tic->api.map_get(map->tic, map->src, tx, ty);
+
+		map->tic->api.key(map->tic, tic_key_ctrl)
+			? replaceTile(map, tile)
+			: fillMap(map, tx, ty, tile);
+
 		history_add(map->history);
 	}
 }
@@ -927,17 +954,7 @@ static void copySelectionToClipboard(Map* map)
 			buffer[0] = sel->w;
 			buffer[1] = sel->h;
 
-			u8* ptr = buffer + 2;
-
-			for(s32 j = sel->y; j < sel->y+sel->h; j++)
-				for(s32 i = sel->x; i < sel->x+sel->w; i++)
-				{
-					s32 x = i, y = j;
-					normalizeMapRect(&x, &y);
-
-					s32 index = x + y * TIC_MAP_WIDTH;
-					*ptr++ = map->src->data[index];
-				}		
+			getMapRect(map, sel, buffer + 2);
 
 			toClipboard(buffer, size, true);
 			free(buffer);			
@@ -957,17 +974,33 @@ static void deleteSelection(Map* map)
 
 	if(sel->w > 0 && sel->h > 0)
 	{
-		for(s32 j = sel->y; j < sel->y+sel->h; j++)
-			for(s32 i = sel->x; i < sel->x+sel->w; i++)
-			{
-				s32 x = i, y = j;
-				normalizeMapRect(&x, &y);
+		fillMapRect(map, sel, 0);
+		history_add(map->history);
+	}
+}
 
-				s32 index = x + y * TIC_MAP_WIDTH;
-				map->src->data[index] = 0;
-			}
+static void moveSelection(Map* map, s32 dx, s32 dy)
+{
+	tic_rect* sel = &map->select.rect;
 
-		history_add(map->history);
+	if(sel->w > 0 && sel->h > 0)
+	{
+		u8* buffer = malloc(sel->w * sel->h);
+
+		if(buffer)
+		{
+			getMapRect(map, sel, buffer);
+			fillMapRect(map, sel, 0);
+
+			sel->x += dx;
+			sel->y += dy;
+			normalizeMapRect(&sel->x, &sel->y);
+
+			setMapRect(map, sel, buffer);
+			history_add(map->history);
+
+			free(buffer);
+		}
 	}
 }
 
@@ -1027,6 +1060,13 @@ static void processKeyboard(Map* map)
 	{
 		if(keyWasPressed(tic_key_z)) 		undo(map);
 		else if(keyWasPressed(tic_key_y)) 	redo(map);
+		else if(map->mode == MAP_SELECT_MODE)
+		{
+			if(keyWasPressed(tic_key_up)) 			moveSelection(map, 0, -1);
+			else if(keyWasPressed(tic_key_down)) 	moveSelection(map, 0, +1);
+			else if(keyWasPressed(tic_key_left)) 	moveSelection(map, -1, 0);
+			else if(keyWasPressed(tic_key_right)) 	moveSelection(map, +1, 0);
+		}
 	}
 	else
 	{
@@ -1039,6 +1079,9 @@ static void processKeyboard(Map* map)
 		else if(keyWasPressed(tic_key_grave)) map->canvas.grid = !map->canvas.grid;
 	}
 
+	// ctrl+arrows move the selection instead of scrolling
+	if(ctrl && map->mode == MAP_SELECT_MODE) return;
+
 	enum{Step = 1};
 
 	if(tic->api.key(tic, tic_key_up)) map->scroll.y -= Step;
@@ -1142,5 +1185,7 @@ void initMap(Map* map, tic_mem* tic, tic_map* src)
 		.scanline = scanline,
 	};
 
+	history_budget(map->history, getConfig()->undoBudget);
+
 	normalizeMap(&map->scroll.x, &map->scroll.y);
 }
\ No newline at end of file
@@ -25,10 +25,12 @@
 
 #define DIALOG_WIDTH (TIC80_WIDTH/2)
 #define DIALOG_HEIGHT (TIC80_HEIGHT/2)
+#define REWIND_STEP TIC80_FRAMERATE
 
 static const char* Rows[] = 
 {
 	"RESUME GAME",
+	"REWIND RAM",
 	"RESET GAME",
 	"GAMEPAD CONFIG",
 	"",
@@ -41,6 +43,20 @@ static void resumeGame(Menu* menu)
 	hideGameMenu();
 }
 
+static void rewindGame(Menu* menu)
+{
+	tic_mem* tic = menu->tic;
+
+	if(studioRewind(REWIND_STEP))
+	{
+		// the rewound frame, shown under its own palette
+		if(menu->bg)
+			memcpy(menu->bg, tic->ram.vram.screen.data, sizeof tic->ram.vram.screen.data);
+
+		playSystemSfx(2);
+	}
+}
+
 static void resetGame(Menu* menu)
 {
 	tic_mem* tic = menu->tic;
@@ -62,7 +78,7 @@ static void closeGame(Menu* menu)
 	exitFromGameMenu();
 }
 
-static void(*const MenuHandlers[])(Menu*) = {resumeGame, resetGame, gamepadConfig, NULL, closeGame, exitStudio};
+static void(*const MenuHandlers[])(Menu*) = {resumeGame, rewindGame, resetGame, gamepadConfig, NULL, closeGame, exitStudio};
 
 static tic_rect getRect(Menu* menu)
 {
@@ -119,7 +135,7 @@ static void drawDialog(Menu* menu)
 
 	{
 		static const char Label[] = "GAME MENU";
-		s32 size = tic->api.text(tic, Label, 0, -TIC_FONT_HEIGHT, 0, false);
+		s32 size = tic->api.text_width(tic, Label, false, 1, false);
 		tic->api.text(tic, Label, rect.x + (DIALOG_WIDTH - size)/2, rect.y-(TOOLBAR_SIZE-2), tic_color_15, false);
 	}
 
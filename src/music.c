@@ -1726,5 +1726,7 @@ void initMusic(Music* music, tic_mem* tic, tic_music* src)
 		.event = onStudioEvent,
 	};
 
+	history_budget(music->history, getConfig()->undoBudget);
+
 	resetSelection(music);
 }
@@ -22,74 +22,541 @@
 
 #include "net.h"
 #include "tic.h"
+#include "defines.h"
+#include "tracing.h"
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <ctype.h>
 
 #include <curl/curl.h>
 
+#define NET_MAX_CONNECTIONS 4
+#define NET_CONNECT_TIMEOUT 10
+#define NET_WAIT_TIMEOUT 100
+#define NET_CACHE_SIZE (4 * 1024 * 1024)
+#define NET_HEADER_SIZE 128
+
+typedef struct
+{
+	u8* data;
+	s32 size;
+	s32 capacity;
+} Buffer;
+
+typedef struct CacheItem CacheItem;
+
+struct CacheItem
+{
+	char* url;
+	char etag[NET_HEADER_SIZE];
+	char modified[NET_HEADER_SIZE];
+
+	void* data;
+	s32 size;
+
+	CacheItem* next;
+};
+
+typedef struct Request Request;
+
+struct Request
+{
+	s32 id;
+	CURL* curl;
+	struct curl_slist* headers;
+
+	char url[FILENAME_MAX];
+	char etag[NET_HEADER_SIZE];
+	char modified[NET_HEADER_SIZE];
+
+	Buffer buffer;
+	CURLcode result;
+	bool done;
+
+	HttpGetCallback callback;
+	void* calldata;
+
+	Request* next;
+};
+
 struct Net
 {
-	struct Curl_easy* curl;
+	CURLM* multi;
+	char host[FILENAME_MAX];
+
+	Request* requests;
+	s32 counter;
+
+	CURL* idle[NET_MAX_CONNECTIONS];
+	s32 idleCount;
+
+	CacheItem* cache;
+	s32 cacheSize;
 };
 
-typedef struct
+static bool reserveBuffer(Buffer* buffer, s32 size)
 {
-    void* buffer;
-    s32 size;
-} CurlData;
+	if(size > buffer->capacity)
+	{
+		s32 capacity = MAX(buffer->capacity, 4096);
+
+		while(capacity < size)
+			capacity *= 2;
+
+		u8* data = realloc(buffer->data, capacity);
+
+		if(!data)
+			return false;
+
+		buffer->data = data;
+		buffer->capacity = capacity;
+	}
+
+	return true;
+}
 
 static size_t writeCallback(void *contents, size_t size, size_t nmemb, void *userp)
 {
-	CurlData* data = (CurlData*)userp;
+	Request* request = (Request*)userp;
+	Buffer* buffer = &request->buffer;
 
 	const size_t total = size * nmemb;
-	data->buffer = realloc(data->buffer, data->size + total);
-	memcpy((u8*)data->buffer + data->size, contents, total);
-	data->size += total;
+
+	if(!reserveBuffer(buffer, buffer->size + (s32)total))
+		return 0;
+
+	memcpy(buffer->data + buffer->size, contents, total);
+	buffer->size += (s32)total;
 
 	return total;
 }
 
+static bool readHeader(const char* line, size_t size, const char* name, char* value, s32 capacity)
+{
+	const size_t len = strlen(name);
+
+	if(size <= len || line[len] != ':')
+		return false;
+
+	for(size_t i = 0; i < len; i++)
+		if(tolower(line[i]) != tolower(name[i]))
+			return false;
+
+	const char* start = line + len + 1;
+	const char* end = line + size;
+
+	while(start < end && isspace(*start)) start++;
+	while(end > start && isspace(end[-1])) end--;
+
+	s32 count = MIN((s32)(end - start), capacity - 1);
+	memcpy(value, start, count);
+	value[count] = '\0';
+
+	return true;
+}
+
+static size_t headerCallback(char* line, size_t size, size_t nitems, void* userp)
+{
+	Request* request = (Request*)userp;
+
+	const size_t total = size * nitems;
+
+	char length[NET_HEADER_SIZE];
+
+	if(!readHeader(line, total, "ETag", request->etag, sizeof request->etag)
+		&& !readHeader(line, total, "Last-Modified", request->modified, sizeof request->modified)
+		&& readHeader(line, total, "Content-Length", length, sizeof length))
+	{
+		s32 contentLength = atoi(length);
+
+		if(contentLength > 0)
+			reserveBuffer(&request->buffer, contentLength);
+	}
+
+	return total;
+}
+
+static CacheItem* findCache(Net* net, const char* url)
+{
+	for(CacheItem* item = net->cache, *prev = NULL; item; prev = item, item = item->next)
+		if(strcmp(item->url, url) == 0)
+		{
+			if(prev)
+			{
+				prev->next = item->next;
+				item->next = net->cache;
+				net->cache = item;
+			}
+
+			return item;
+		}
+
+	return NULL;
+}
+
+static void freeCacheItem(CacheItem* item)
+{
+	free(item->url);
+	free(item->data);
+	free(item);
+}
+
+static void storeCache(Net* net, const Request* request)
+{
+	if(request->buffer.size > NET_CACHE_SIZE / 4)
+		return;
+
+	CacheItem* item = findCache(net, request->url);
+
+	if(item)
+	{
+		net->cacheSize -= item->size;
+		free(item->data);
+	}
+	else
+	{
+		item = (CacheItem*)calloc(1, sizeof(CacheItem));
+
+		if(!item)
+			return;
+
+		item->url = strdup(request->url);
+		item->next = net->cache;
+		net->cache = item;
+	}
+
+	strcpy(item->etag, request->etag);
+	strcpy(item->modified, request->modified);
+
+	item->size = request->buffer.size;
+	item->data = malloc(item->size);
+
+	if(item->data)
+		memcpy(item->data, request->buffer.data, item->size);
+	else item->size = 0;
+
+	net->cacheSize += item->size;
+
+	// evict least recently used responses from the tail
+	while(net->cacheSize > NET_CACHE_SIZE)
+	{
+		CacheItem** last = &net->cache;
+
+		while((*last)->next)
+			last = &(*last)->next;
+
+		net->cacheSize -= (*last)->size;
+		freeCacheItem(*last);
+		*last = NULL;
+	}
+}
+
+static Request* findRequest(Net* net, s32 id)
+{
+	for(Request* request = net->requests; request; request = request->next)
+		if(request->id == id)
+			return request;
+
+	return NULL;
+}
+
+static Request* findDoneRequest(Net* net)
+{
+	for(Request* request = net->requests; request; request = request->next)
+		if(request->done)
+			return request;
+
+	return NULL;
+}
+
+static void unlinkRequest(Net* net, Request* request)
+{
+	for(Request** it = &net->requests; *it; it = &(*it)->next)
+		if(*it == request)
+		{
+			*it = request->next;
+			break;
+		}
+}
+
+static void freeRequest(Net* net, Request* request)
+{
+	if(request->curl)
+	{
+		curl_multi_remove_handle(net->multi, request->curl);
+
+		if(net->idleCount < COUNT_OF(net->idle))
+		{
+			curl_easy_reset(request->curl);
+			net->idle[net->idleCount++] = request->curl;
+		}
+		else curl_easy_cleanup(request->curl);
+	}
+
+	if(request->headers)
+		curl_slist_free_all(request->headers);
+
+	free(request->buffer.data);
+	free(request);
+}
+
+static void completeRequest(Net* net, Request* request)
+{
+	long code = 0;
+
+	if(request->curl)
+		curl_easy_getinfo(request->curl, CURLINFO_RESPONSE_CODE, &code);
+
+	HttpGetData data =
+	{
+		.status = HttpGetError,
+		.code = (s32)code,
+		.url = request->url,
+		.calldata = request->calldata,
+	};
+
+	if(request->result == CURLE_OK)
+	{
+		if(code == 304)
+		{
+			const CacheItem* item = findCache(net, request->url);
+
+			if(item)
+			{
+				data.status = HttpGetDone;
+				data.cached = true;
+				data.data = item->data;
+				data.size = item->size;
+			}
+		}
+		else if(code >= 200 && code < 300)
+		{
+			data.status = HttpGetDone;
+			data.data = request->buffer.data;
+			data.size = request->buffer.size;
+
+			if(strlen(request->etag) || strlen(request->modified))
+				storeCache(net, request);
+		}
+	}
+
+	// callback is free to queue or cancel other requests
+	unlinkRequest(net, request);
+	request->callback(&data);
+	freeRequest(net, request);
+}
+
+static void performRequests(Net* net)
+{
+	if(!net->multi)
+		return;
+
+	s32 running = 0;
+	curl_multi_perform(net->multi, &running);
+
+	CURLMsg* msg = NULL;
+	s32 left = 0;
+
+	while((msg = curl_multi_info_read(net->multi, &left)))
+	{
+		if(msg->msg == CURLMSG_DONE)
+		{
+			Request* request = NULL;
+			curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&request);
+
+			if(request)
+			{
+				request->result = msg->data.result;
+				request->done = true;
+			}
+		}
+	}
+}
+
+s32 netGet(Net* net, const char* path, HttpGetCallback callback, void* calldata)
+{
+	Request* request = (Request*)calloc(1, sizeof(Request));
+
+	if(!request)
+		return 0;
+
+	request->id = ++net->counter;
+	request->callback = callback;
+	request->calldata = calldata;
+	snprintf(request->url, sizeof request->url, "%s%s", net->host, path);
+
+	request->curl = net->idleCount ? net->idle[--net->idleCount] : curl_easy_init();
+
+	// append to keep completion order for requests finished in the same tick
+	{
+		Request** last = &net->requests;
+		while(*last) last = &(*last)->next;
+		*last = request;
+	}
+
+	CURL* curl = request->curl;
+
+	if(curl && net->multi)
+	{
+		curl_easy_setopt(curl, CURLOPT_URL, request->url);
+		curl_easy_setopt(curl, CURLOPT_PRIVATE, request);
+		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+		curl_easy_setopt(curl, CURLOPT_WRITEDATA, request);
+		curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
+		curl_easy_setopt(curl, CURLOPT_HEADERDATA, request);
+		curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+		curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+		curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, (long)NET_CONNECT_TIMEOUT);
+
+		const CacheItem* item = findCache(net, request->url);
+
+		if(item)
+		{
+			char header[NET_HEADER_SIZE * 2];
+
+			if(strlen(item->etag))
+			{
+				snprintf(header, sizeof header, "If-None-Match: %s", item->etag);
+				request->headers = curl_slist_append(request->headers, header);
+			}
+
+			if(strlen(item->modified))
+			{
+				snprintf(header, sizeof header, "If-Modified-Since: %s", item->modified);
+				request->headers = curl_slist_append(request->headers, header);
+			}
+
+			curl_easy_setopt(curl, CURLOPT_HTTPHEADER, request->headers);
+		}
+
+		if(curl_multi_add_handle(net->multi, curl) == CURLM_OK)
+			return request->id;
+	}
+
+	request->result = CURLE_FAILED_INIT;
+	request->done = true;
+
+	return request->id;
+}
+
+void netCancel(Net* net, s32 id)
+{
+	Request* request = findRequest(net, id);
+
+	if(request)
+	{
+		unlinkRequest(net, request);
+		freeRequest(net, request);
+	}
+}
+
+void netTick(Net* net)
+{
+	performRequests(net);
+
+	Request* request = NULL;
+	while((request = findDoneRequest(net)))
+		completeRequest(net, request);
+}
+
+typedef struct
+{
+	bool done;
+	void* buffer;
+	s32 size;
+} BlockingData;
+
+static void onBlockingGet(const HttpGetData* data)
+{
+	BlockingData* blocking = (BlockingData*)data->calldata;
+
+	blocking->done = true;
+
+	if(data->status == HttpGetDone && data->size)
+	{
+		blocking->buffer = malloc(data->size);
+
+		if(blocking->buffer)
+		{
+			memcpy(blocking->buffer, data->data, data->size);
+			blocking->size = data->size;
+		}
+	}
+}
+
 void* netGetRequest(Net* net, const char* path, s32* size)
 {
-	CurlData data = {NULL, 0};
+	BlockingData data = {false, NULL, 0};
+
+	TRACE_BEGIN("net get");
 
-	if(net->curl)
+	s32 id = netGet(net, path, onBlockingGet, &data);
+
+	// only this request is completed here, other callbacks wait for the next netTick
+	while(!data.done)
 	{
-		char url[FILENAME_MAX] = "http://" TIC_HOST;
-		strcat(url, path);
-		
-		curl_easy_setopt(net->curl, CURLOPT_URL, url);
-		curl_easy_setopt(net->curl, CURLOPT_WRITEDATA, &data);
+		performRequests(net);
+
+		Request* request = findRequest(net, id);
 
-		if(curl_easy_perform(net->curl) != CURLE_OK)
-			return NULL;
+		if(!request)
+			break;
+
+		if(request->done)
+			completeRequest(net, request);
+		else curl_multi_wait(net->multi, NULL, 0, NET_WAIT_TIMEOUT, NULL);
 	}
 
+	TRACE_END("net get");
+
 	*size = data.size;
 
-    return data.buffer;
+	return data.buffer;
 }
 
-Net* createNet()
+Net* createNet(const char* host)
 {
 	Net* net = (Net*)malloc(sizeof(Net));
 
 	*net = (Net)
 	{
-		.curl = curl_easy_init()
+		.multi = curl_multi_init(),
 	};
 
-	curl_easy_setopt(net->curl, CURLOPT_WRITEFUNCTION, writeCallback);
+	strncpy(net->host, host ? host : "http://" TIC_HOST, sizeof net->host - 1);
+
+	if(net->multi)
+		curl_multi_setopt(net->multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)NET_MAX_CONNECTIONS);
 
 	return net;
 }
 
 void closeNet(Net* net)
 {
-	if(net->curl)
-		curl_easy_cleanup(net->curl);
+	// pending callbacks still own their calldata
+	while(net->requests)
+	{
+		Request* request = net->requests;
+		net->requests = request->next;
+
+		request->callback(&(HttpGetData){.status = HttpGetCancel, .url = request->url, .calldata = request->calldata});
+		freeRequest(net, request);
+	}
+
+	for(s32 i = 0; i < net->idleCount; i++)
+		curl_easy_cleanup(net->idle[i]);
+
+	while(net->cache)
+	{
+		CacheItem* item = net->cache;
+		net->cache = item->next;
+		freeCacheItem(item);
+	}
+
+	if(net->multi)
+		curl_multi_cleanup(net->multi);
 
 	free(net);
 }
@@ -22,10 +22,37 @@
 
 #pragma once
 
-#include "fs.h"
+#include <tic80_types.h>
+
+typedef enum
+{
+	HttpGetDone,
+	HttpGetError,
+
+	// the net is closing, the callback only has to release its calldata
+	HttpGetCancel,
+} HttpGetStatus;
+
+typedef struct
+{
+	HttpGetStatus status;
+	s32 code;
+	bool cached;
+
+	const void* data;
+	s32 size;
+
+	const char* url;
+	void* calldata;
+} HttpGetData;
+
+typedef void(*HttpGetCallback)(const HttpGetData*);
 
 typedef struct Net Net;
 
-Net* createNet();
+Net* createNet(const char* host);
+s32 netGet(Net* net, const char* path, HttpGetCallback callback, void* calldata);
+void netCancel(Net* net, s32 id);
+void netTick(Net* net);
 void* netGetRequest(Net* net, const char* path, s32* size);
-void closeNet(Net* net);
\ No newline at end of file
+void closeNet(Net* net);
@@ -21,6 +21,9 @@
 // SOFTWARE.
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <SDL.h>
 #include <tic80.h>
 
@@ -40,6 +43,7 @@ static void onExit()
 int main(int argc, char **argv)
 {
 	char* cart = (argc > 1) ? argv[1] : "cart.tic";
+	char* record = (argc > 3 && strcmp(argv[2], "-record") == 0) ? argv[3] : NULL;
 	FILE* file = fopen(cart, "rb");
 
 	if(file)
@@ -94,6 +98,9 @@ int main(int argc, char **argv)
 				tic->callback.exit = onExit;
 
 				tic80_load(tic, cart, size);
+
+				if(record)
+					tic80_record_start(tic, (u32)time(NULL));
 				
 				if(tic)
 				{
@@ -142,7 +149,14 @@ int main(int argc, char **argv)
 
 						nextTick += Delta;
 
-						tic80_tick(tic, input);
+						{
+							void* pixels = NULL;
+							int pitch = 0;
+							SDL_LockTexture(texture, NULL, &pixels, &pitch);
+							tic80_set_framebuffer(tic, pixels, pitch, TIC80_PIXEL_ABGR8888, true);
+							tic80_tick(tic, input);
+							SDL_UnlockTexture(texture);
+						}
 
 						if (!audioStarted && audioDevice)
 						{
@@ -164,15 +178,7 @@ int main(int argc, char **argv)
 						}
 
 						SDL_RenderClear(renderer);
-
-						{
-							void* pixels = NULL;
-							int pitch = 0;
-							SDL_LockTexture(texture, NULL, &pixels, &pitch);
-							SDL_memcpy(pixels, tic->screen, pitch * TIC80_FULLHEIGHT);
-							SDL_UnlockTexture(texture);
-							SDL_RenderCopy(renderer, texture, NULL, NULL);
-						}
+						SDL_RenderCopy(renderer, texture, NULL, NULL);
 
 						SDL_RenderPresent(renderer);
 
@@ -186,6 +192,21 @@ int main(int argc, char **argv)
 
 					}
 
+					if(record)
+					{
+						u32 size = 0;
+						void* data = tic80_record_stop(tic, &size);
+						FILE* file = data ? fopen(record, "wb") : NULL;
+
+						if(file)
+						{
+							fwrite(data, size, 1, file);
+							fclose(file);
+						}
+
+						free(data);
+					}
+
 					tic80_delete(tic);
 				}
 
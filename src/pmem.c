@@ -0,0 +1,223 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pmem.h"
+#include "studio.h"
+#include "ext/thread.h"
+#include "tracing.h"
+
+typedef struct
+{
+	char path[FILENAME_MAX];
+	u8 data[sizeof(tic_persistent)];
+	s32 size;
+} PMemData;
+
+struct PMem
+{
+	tic_thread* thread;
+	tic_mutex* mutex;
+	tic_cond* cond;
+
+	// owned by the frame thread
+	PMemData current;
+	bool dirty;
+	u64 start;
+
+	// handed over to the writer thread
+	PMemData queue;
+	bool queued;
+	bool writing;
+	bool quit;
+
+	PMemData written;
+	PMemStats stats;
+};
+
+static void writeData(PMem* pmem, const PMemData* data)
+{
+	bool same = data->size == pmem->written.size
+		&& strcmp(data->path, pmem->written.path) == 0
+		&& memcmp(data->data, pmem->written.data, data->size) == 0;
+
+	bool done = same || fsWriteFileAtomic(data->path, data->data, data->size);
+
+	tic_mutex_lock(pmem->mutex);
+
+	if(same) pmem->stats.skipped++;
+	else if(done) pmem->stats.writes++;
+	else pmem->stats.failures++;
+
+	tic_mutex_unlock(pmem->mutex);
+
+	if(done)
+		pmem->written = *data;
+}
+
+static void writerThread(void* param)
+{
+	PMem* pmem = (PMem*)param;
+
+	tic_mutex_lock(pmem->mutex);
+
+	while(!pmem->quit || pmem->queued)
+	{
+		if(pmem->queued)
+		{
+			PMemData data = pmem->queue;
+			pmem->queued = false;
+			pmem->writing = true;
+			tic_mutex_unlock(pmem->mutex);
+
+			writeData(pmem, &data);
+
+			tic_mutex_lock(pmem->mutex);
+			pmem->writing = false;
+			tic_cond_broadcast(pmem->cond);
+		}
+		else tic_cond_wait(pmem->cond, pmem->mutex);
+	}
+
+	tic_mutex_unlock(pmem->mutex);
+}
+
+static u64 getTime()
+{
+	const System* system = getSystem();
+	return system->getPerformanceCounter() * 1000 / system->getPerformanceFrequency();
+}
+
+static void submit(PMem* pmem)
+{
+	if(!pmem->dirty)
+		return;
+
+	pmem->dirty = false;
+
+	if(pmem->thread)
+	{
+		tic_mutex_lock(pmem->mutex);
+		pmem->queue = pmem->current;
+		pmem->queued = true;
+		tic_cond_broadcast(pmem->cond);
+		tic_mutex_unlock(pmem->mutex);
+	}
+	else writeData(pmem, &pmem->current);
+}
+
+PMem* pmem_create()
+{
+	PMem* pmem = (PMem*)calloc(1, sizeof(PMem));
+
+	if(pmem)
+	{
+		pmem->mutex = tic_mutex_create();
+		pmem->cond = tic_cond_create();
+
+		if(pmem->mutex && pmem->cond)
+			pmem->thread = tic_thread_create(writerThread, pmem);
+	}
+
+	return pmem;
+}
+
+void pmem_update(PMem* pmem, FileSystem* fs, const char* name, const void* data, s32 size)
+{
+	PMemData* current = &pmem->current;
+
+	// a different file was requested, the previous one has to be stored first
+	if(pmem->dirty && current->size)
+	{
+		char path[FILENAME_MAX];
+		fsGetRootFilePath(fs, name, path);
+
+		if(strcmp(path, current->path) != 0)
+			submit(pmem);
+	}
+
+	if(!pmem->dirty)
+		pmem->start = getTime();
+
+	fsGetRootFilePath(fs, name, current->path);
+	current->size = MIN(size, (s32)sizeof current->data);
+	memcpy(current->data, data, current->size);
+
+	pmem->dirty = true;
+
+	tic_mutex_lock(pmem->mutex);
+	pmem->stats.requests++;
+	tic_mutex_unlock(pmem->mutex);
+}
+
+void pmem_tick(PMem* pmem, s32 interval)
+{
+	if(pmem->dirty && getTime() - pmem->start >= (u64)MAX(interval, 0))
+		submit(pmem);
+}
+
+void pmem_flush(PMem* pmem)
+{
+	TRACE_BEGIN("pmem flush");
+
+	submit(pmem);
+
+	if(pmem->thread)
+	{
+		tic_mutex_lock(pmem->mutex);
+
+		while(pmem->queued || pmem->writing)
+			tic_cond_wait(pmem->cond, pmem->mutex);
+
+		tic_mutex_unlock(pmem->mutex);
+	}
+
+	TRACE_END("pmem flush");
+}
+
+PMemStats pmem_stats(PMem* pmem)
+{
+	tic_mutex_lock(pmem->mutex);
+	PMemStats stats = pmem->stats;
+	tic_mutex_unlock(pmem->mutex);
+
+	return stats;
+}
+
+void pmem_delete(PMem* pmem)
+{
+	pmem_flush(pmem);
+
+	if(pmem->thread)
+	{
+		tic_mutex_lock(pmem->mutex);
+		pmem->quit = true;
+		tic_cond_broadcast(pmem->cond);
+		tic_mutex_unlock(pmem->mutex);
+
+		tic_thread_join(pmem->thread);
+	}
+
+	if(pmem->cond) tic_cond_delete(pmem->cond);
+	if(pmem->mutex) tic_mutex_delete(pmem->mutex);
+
+	free(pmem);
+}
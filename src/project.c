@@ -0,0 +1,352 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "project.h"
+#include "defines.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {char* tag; s32 count; s32 offset; s32 size; bool flip;} BinarySection;
+static const BinarySection BinarySections[] = 
+{
+	{"TILES", 		TIC_BANK_SPRITES, 	offsetof(tic_bank, tiles), 			sizeof(tic_tile), 			true},
+	{"SPRITES", 	TIC_BANK_SPRITES, 	offsetof(tic_bank, sprites), 		sizeof(tic_tile), 			true},
+	{"MAP", 		TIC_MAP_HEIGHT, 	offsetof(tic_bank, map), 			TIC_MAP_WIDTH, 				true},
+	{"WAVES", 		WAVES_COUNT, 		offsetof(tic_bank, sfx.waveforms), 	sizeof(tic_waveform), 		true},
+	{"SFX", 		SFX_COUNT, 			offsetof(tic_bank, sfx.samples), 	sizeof(tic_sample), 		true},
+	{"PATTERNS", 	MUSIC_PATTERNS, 	offsetof(tic_bank, music.patterns), sizeof(tic_track_pattern), 	true},
+	{"TRACKS", 		MUSIC_TRACKS, 		offsetof(tic_bank, music.tracks), 	sizeof(tic_track), 			true},
+	{"FLAGS", 		TIC_SPRITE_BANKS, 	offsetof(tic_bank, flags), 			TIC_BANK_SPRITES, 			true},
+	{"PALETTE", 	1, 					offsetof(tic_bank, palette), 		sizeof(tic_palette), 		false},
+};
+
+static const char CoverTag[] = "COVER";
+
+static const char HexDigits[] = "0123456789abcdef";
+
+static void buf2str(const void* data, s32 size, char* ptr, bool flip)
+{
+	const u8* src = data;
+
+	for(s32 i = 0; i < size; i++)
+	{
+		u8 hi = src[i] >> 4, lo = src[i] & 0xf;
+
+		*ptr++ = HexDigits[flip ? lo : hi];
+		*ptr++ = HexDigits[flip ? hi : lo];
+	}
+}
+
+static bool bufferEmpty(const u8* data, s32 size)
+{
+	for(s32 i = 0; i < size; i++)
+		if(*data++)
+			return false;
+
+	return true;
+}
+
+static char* saveTextSection(char* ptr, const char* data, s32 size)
+{
+	const char* end = memchr(data, '\0', size);
+	s32 len = end ? (s32)(end - data) : size;
+
+	if(len == 0)
+		return ptr;
+
+	memcpy(ptr, data, len);
+	ptr += len;
+	*ptr++ = '\n';
+
+	return ptr;
+}
+
+static char* saveBinaryBuffer(char* ptr, const char* comment, const void* data, s32 size, s32 row, bool flip)
+{
+	if(bufferEmpty(data, size)) 
+		return ptr;
+
+	ptr += sprintf(ptr, "%s %03i:", comment, row);
+
+	buf2str(data, size, ptr, flip);
+	ptr += size * 2;
+
+	*ptr++ = '\n';
+
+	return ptr;
+}
+
+static char* saveBinarySection(char* ptr, const char* comment, const char* tag, s32 count, const void* data, s32 size, bool flip)
+{
+	if(bufferEmpty(data, size * count)) 
+		return ptr;
+
+	ptr += sprintf(ptr, "%s <%s>\n", comment, tag);
+
+	for(s32 i = 0; i < count; i++, data = (u8*)data + size)
+		ptr = saveBinaryBuffer(ptr, comment, data, size, i, flip);
+
+	ptr += sprintf(ptr, "%s </%s>\n\n", comment, tag);
+
+	return ptr;
+}
+
+static void makeTag(const char* tag, char* out, s32 bank)
+{
+	if(bank) sprintf(out, "%s%i", tag, bank);
+	else strcpy(out, tag);
+}
+
+s32 tic_project_save(const char* comment, void* buffer, const tic_cartridge* cart)
+{
+	char* stream = buffer;
+	char* ptr = saveTextSection(stream, cart->code.data, sizeof(tic_code));
+	char tag[16];
+
+	for(s32 i = 0; i < COUNT_OF(BinarySections); i++)
+	{
+		const BinarySection* section = &BinarySections[i];
+
+		for(s32 b = 0; b < TIC_BANKS; b++)
+		{
+			makeTag(section->tag, tag, b);
+
+			ptr = saveBinarySection(ptr, comment, tag, section->count, 
+				(u8*)&cart->banks[b] + section->offset, section->size, section->flip);
+		}
+	}
+
+	ptr = saveBinarySection(ptr, comment, CoverTag, 1, &cart->cover, cart->cover.size + sizeof(s32), true);
+
+	*ptr = '\0';
+
+	return (s32)(ptr - stream);
+}
+
+typedef struct
+{
+	const char* ptr;
+	const char* end;
+} Line;
+
+typedef struct
+{
+	u8* dst;
+	s32 count;
+	s32 size;
+	bool flip;
+} Target;
+
+static bool readLine(const char** ptr, const char* end, Line* line)
+{
+	if(*ptr >= end)
+		return false;
+
+	line->ptr = *ptr;
+
+	const char* eol = memchr(*ptr, '\n', end - *ptr);
+	line->end = eol ? eol : end;
+	*ptr = eol ? eol + 1 : end;
+
+	if(line->end > line->ptr && line->end[-1] == '\r')
+		line->end--;
+
+	return true;
+}
+
+static const char* skipComment(const Line* line, const char* comment, s32 commentLen)
+{
+	if(line->end - line->ptr < commentLen + 1 
+		|| memcmp(line->ptr, comment, commentLen) != 0 
+		|| line->ptr[commentLen] != ' ')
+		return NULL;
+
+	return line->ptr + commentLen + 1;
+}
+
+// matches '<comment> <TAG>' or '<comment> </TAG>' and returns the tag name
+static bool readTag(const Line* line, const char* comment, s32 commentLen, bool close, const char** tag, s32* len)
+{
+	const char* ptr = skipComment(line, comment, commentLen);
+
+	if(!ptr || ptr >= line->end || *ptr++ != '<')
+		return false;
+
+	if(close && (ptr >= line->end || *ptr++ != '/'))
+		return false;
+
+	const char* end = memchr(ptr, '>', line->end - ptr);
+
+	if(!end)
+		return false;
+
+	*tag = ptr;
+	*len = (s32)(end - ptr);
+
+	return close || **tag != '/';
+}
+
+static bool findTarget(const char* tag, s32 len, tic_cartridge* cart, Target* target)
+{
+	if(len == sizeof CoverTag - 1 && memcmp(tag, CoverTag, len) == 0)
+	{
+		*target = (Target){(u8*)&cart->cover, 1, sizeof(tic_cover_image), true};
+		return true;
+	}
+
+	for(s32 i = 0; i < COUNT_OF(BinarySections); i++)
+	{
+		const BinarySection* section = &BinarySections[i];
+		s32 tagLen = (s32)strlen(section->tag);
+
+		if(len < tagLen || memcmp(tag, section->tag, tagLen) != 0)
+			continue;
+
+		s32 bank = 0;
+
+		for(const char* ptr = tag + tagLen; ptr < tag + len; ptr++)
+		{
+			if(*ptr < '0' || *ptr > '9')
+				return false;
+
+			bank = bank * 10 + (*ptr - '0');
+		}
+
+		if(bank >= TIC_BANKS)
+			return false;
+
+		*target = (Target){(u8*)&cart->banks[bank] + section->offset, section->count, section->size, section->flip};
+		return true;
+	}
+
+	return false;
+}
+
+static inline s32 hex2int(char c)
+{
+	if(c >= '0' && c <= '9') return c - '0';
+	if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+
+	return 0;
+}
+
+// '<comment> 000:00112233...'
+static void readRow(const Line* line, const char* comment, s32 commentLen, const Target* target)
+{
+	const char* ptr = skipComment(line, comment, commentLen);
+
+	if(!ptr)
+		return;
+
+	s32 index = 0;
+
+	while(ptr < line->end && *ptr >= '0' && *ptr <= '9')
+		index = index * 10 + (*ptr++ - '0');
+
+	if(ptr >= line->end || *ptr++ != ':' || index >= target->count)
+		return;
+
+	u8* dst = target->dst + target->size * index;
+	s32 size = MIN((s32)(line->end - ptr) / 2, target->size);
+
+	for(s32 i = 0; i < size; i++, ptr += 2)
+	{
+		s32 first = hex2int(ptr[0]), second = hex2int(ptr[1]);
+		dst[i] = target->flip ? (second << 4 | first) : (first << 4 | second);
+	}
+}
+
+bool tic_project_load(const char* comment, const char* data, s32 size, tic_cartridge* dst)
+{
+	const s32 commentLen = (s32)strlen(comment);
+	const char* ptr = data;
+	const char* end = data + size;
+
+	bool done = false;
+
+	Line line;
+	const char* tag = NULL;
+	s32 tagLen = 0;
+
+	// everything before the first section tag is code
+	{
+		char* code = dst->code.data;
+		char* codeEnd = code + sizeof(tic_code);
+		const char* start = ptr;
+
+		while(readLine(&ptr, end, &line))
+		{
+			if(readTag(&line, comment, commentLen, false, &tag, &tagLen))
+			{
+				ptr = line.ptr;
+				break;
+			}
+		}
+
+		const char* text = ptr;
+
+		// the newline before the tag belongs to the format
+		if(text > start && text[-1] == '\n') text--;
+		if(text > start && text[-1] == '\r') text--;
+
+		if(text > start)
+		{
+			memset(code, 0, sizeof(tic_code));
+
+			for(const char* src = start; src < text && code < codeEnd; src++)
+				if(*src != '\r')
+					*code++ = *src;
+
+			done = true;
+		}
+	}
+
+	Target target;
+	bool active = false;
+
+	while(readLine(&ptr, end, &line))
+	{
+		if(active)
+		{
+			const char* closeTag = NULL;
+			s32 closeLen = 0;
+
+			if(readTag(&line, comment, commentLen, true, &closeTag, &closeLen))
+				active = false;
+			else readRow(&line, comment, commentLen, &target);
+		}
+		else if(readTag(&line, comment, commentLen, false, &tag, &tagLen))
+		{
+			if(findTarget(tag, tagLen, dst, &target))
+			{
+				// the text only has non-empty rows, the rest of the section is cleared
+				memset(target.dst, 0, target.count * target.size);
+				active = done = true;
+			}
+		}
+	}
+
+	return done;
+}
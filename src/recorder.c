@@ -0,0 +1,198 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "recorder.h"
+#include "defines.h"
+#include "ext/gif.h"
+#include "ext/thread.h"
+
+#include <tic80.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RECORDER_QUEUE 16
+#define RECORDER_COLORS 256
+#define RECORDER_DELAY 2 // gif delays are in 1/100 s
+
+typedef struct
+{
+	u8 data[TIC80_FULLWIDTH * TIC80_FULLHEIGHT];
+	gif_color palette[RECORDER_COLORS];
+	s32 colors;
+} RecorderFrame;
+
+struct Recorder
+{
+	gif_writer* writer;
+
+	tic_thread* thread;
+	tic_mutex* mutex;
+	tic_cond* cond;
+
+	// frames are handed over through a ring, the frame thread waits when it is full
+	RecorderFrame* queue;
+	s32 head;
+	s32 count;
+	bool quit;
+	bool error;
+
+	// owned by the frame thread
+	s32 input;
+	s32 output;
+};
+
+static void indexFrame(RecorderFrame* frame, const u32* pixels)
+{
+	frame->colors = gif_index_frame(pixels, COUNT_OF(frame->data), frame->data, frame->palette);
+}
+
+static bool writeFrame(Recorder* recorder, const RecorderFrame* frame)
+{
+	return gif_writer_frame(recorder->writer, frame->data, frame->palette, frame->colors, RECORDER_DELAY);
+}
+
+static void encoderThread(void* param)
+{
+	Recorder* recorder = (Recorder*)param;
+
+	tic_mutex_lock(recorder->mutex);
+
+	while(!recorder->quit || recorder->count)
+	{
+		if(recorder->count)
+		{
+			const RecorderFrame* frame = &recorder->queue[recorder->head];
+			tic_mutex_unlock(recorder->mutex);
+
+			bool done = writeFrame(recorder, frame);
+
+			tic_mutex_lock(recorder->mutex);
+			recorder->error |= !done;
+			recorder->head = (recorder->head + 1) % RECORDER_QUEUE;
+			recorder->count--;
+			tic_cond_broadcast(recorder->cond);
+		}
+		else tic_cond_wait(recorder->cond, recorder->mutex);
+	}
+
+	tic_mutex_unlock(recorder->mutex);
+}
+
+Recorder* recorder_create(const char* path, s32 scale)
+{
+	Recorder* recorder = (Recorder*)calloc(1, sizeof(Recorder));
+
+	if(recorder)
+	{
+		recorder->writer = gif_writer_open(path, TIC80_FULLWIDTH, TIC80_FULLHEIGHT, scale);
+		recorder->mutex = tic_mutex_create();
+		recorder->cond = tic_cond_create();
+
+		if(recorder->writer && recorder->mutex && recorder->cond)
+		{
+			recorder->queue = (RecorderFrame*)malloc(sizeof(RecorderFrame) * RECORDER_QUEUE);
+
+			if(recorder->queue)
+				recorder->thread = tic_thread_create(encoderThread, recorder);
+		}
+
+		// without threads frames are encoded as they come
+		if(recorder->writer && !recorder->thread)
+		{
+			free(recorder->queue);
+			recorder->queue = (RecorderFrame*)malloc(sizeof(RecorderFrame));
+		}
+
+		if(!recorder->writer || !recorder->queue)
+		{
+			recorder_close(recorder);
+			recorder = NULL;
+		}
+	}
+
+	return recorder;
+}
+
+// 60 fps can't be expressed in 1/100 s delays, it's written as 50 fps by dropping every sixth frame
+static s32 getInputFrame(s32 output)
+{
+	enum {DelayUnits = 100};
+	return (output * TIC80_FRAMERATE * RECORDER_DELAY * 2 + 1) / (2 * DelayUnits);
+}
+
+void recorder_frame(Recorder* recorder, const u32* pixels)
+{
+	if(getInputFrame(recorder->output) != recorder->input++)
+		return;
+
+	recorder->output++;
+
+	if(recorder->thread)
+	{
+		tic_mutex_lock(recorder->mutex);
+
+		while(recorder->count == RECORDER_QUEUE)
+			tic_cond_wait(recorder->cond, recorder->mutex);
+
+		RecorderFrame* frame = &recorder->queue[(recorder->head + recorder->count) % RECORDER_QUEUE];
+		tic_mutex_unlock(recorder->mutex);
+
+		indexFrame(frame, pixels);
+
+		tic_mutex_lock(recorder->mutex);
+		recorder->count++;
+		tic_cond_broadcast(recorder->cond);
+		tic_mutex_unlock(recorder->mutex);
+	}
+	else
+	{
+		indexFrame(recorder->queue, pixels);
+		recorder->error |= !writeFrame(recorder, recorder->queue);
+	}
+}
+
+bool recorder_close(Recorder* recorder)
+{
+	if(recorder->thread)
+	{
+		tic_mutex_lock(recorder->mutex);
+		recorder->quit = true;
+		tic_cond_broadcast(recorder->cond);
+		tic_mutex_unlock(recorder->mutex);
+
+		tic_thread_join(recorder->thread);
+	}
+
+	bool result = !recorder->error && recorder->output > 0;
+
+	if(recorder->writer)
+		result &= gif_writer_close(recorder->writer);
+	else result = false;
+
+	if(recorder->cond) tic_cond_delete(recorder->cond);
+	if(recorder->mutex) tic_mutex_delete(recorder->mutex);
+
+	free(recorder->queue);
+	free(recorder);
+
+	return result;
+}
@@ -0,0 +1,357 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "replay.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_MAGIC "TICR"
+#define REPLAY_VERSION 2
+#define REPLAY_HEADER_SIZE(version) (4 + sizeof(u32) * ((version) > 1 ? 8 : 7))
+
+enum
+{
+	ChangedGamepads = 1 << 0,
+	ChangedMouse = 1 << 1,
+	ChangedKeyboard = 1 << 2,
+};
+
+typedef struct
+{
+	u8* data;
+	u32 size;
+	u32 capacity;
+} Buffer;
+
+struct Replay
+{
+	ReplayInfo info;
+
+	Buffer input;
+	Buffer hashes;
+
+	// playback position
+	u32 pos;
+	u32 frame;
+	u32 same;
+	bool counted;
+	tic80_input last;
+};
+
+static bool grow(Buffer* buffer, u32 size)
+{
+	if(buffer->size + size > buffer->capacity)
+	{
+		u32 capacity = buffer->capacity ? buffer->capacity : 1024;
+		while(buffer->size + size > capacity) capacity *= 2;
+
+		u8* data = realloc(buffer->data, capacity);
+		if(!data) return false;
+
+		buffer->data = data;
+		buffer->capacity = capacity;
+	}
+
+	return true;
+}
+
+static void putBytes(Buffer* buffer, const void* data, u32 size)
+{
+	if(grow(buffer, size))
+	{
+		memcpy(buffer->data + buffer->size, data, size);
+		buffer->size += size;
+	}
+}
+
+static void putU32(Buffer* buffer, u32 value)
+{
+	u8 bytes[] = {value, value >> 8, value >> 16, value >> 24};
+	putBytes(buffer, bytes, sizeof bytes);
+}
+
+static void putCount(Buffer* buffer, u32 value)
+{
+	for(; value >= 0x80; value >>= 7)
+		putBytes(buffer, &(u8){value | 0x80}, 1);
+
+	putBytes(buffer, &(u8){value}, 1);
+}
+
+static inline u32 getU32(const u8* data)
+{
+	return data[0] | data[1] << 8 | data[2] << 16 | (u32)data[3] << 24;
+}
+
+static bool getBytes(Replay* replay, void* data, u32 size)
+{
+	if(replay->pos + size > replay->input.size)
+		return false;
+
+	memcpy(data, replay->input.data + replay->pos, size);
+	replay->pos += size;
+
+	return true;
+}
+
+static bool getCount(Replay* replay, u32* value)
+{
+	u32 result = 0;
+	u8 byte = 0;
+
+	for(s32 shift = 0; shift < 32; shift += 7)
+	{
+		if(!getBytes(replay, &byte, 1))
+			return false;
+
+		result |= (u32)(byte & 0x7f) << shift;
+
+		if(!(byte & 0x80)) break;
+	}
+
+	*value = result;
+
+	return true;
+}
+
+static void putMouse(Buffer* buffer, const tic80_mouse* mouse)
+{
+	u8 bytes[] = {mouse->x, mouse->y, mouse->btns, mouse->btns >> 8};
+	putBytes(buffer, bytes, sizeof bytes);
+}
+
+static bool getMouse(Replay* replay, tic80_mouse* mouse)
+{
+	u8 bytes[4];
+
+	if(!getBytes(replay, bytes, sizeof bytes))
+		return false;
+
+	mouse->x = bytes[0];
+	mouse->y = bytes[1];
+	mouse->btns = bytes[2] | bytes[3] << 8;
+
+	return true;
+}
+
+static void getChanges(Replay* replay, tic80_input* input)
+{
+	u8 changed = 0, bytes[4];
+
+	if(!getBytes(replay, &changed, 1))
+		return;
+
+	if(changed & ChangedGamepads && getBytes(replay, bytes, sizeof bytes)) 
+		input->gamepads.data = getU32(bytes);
+
+	if(changed & ChangedMouse) getMouse(replay, &input->mouse);
+	if(changed & ChangedKeyboard) getBytes(replay, input->keyboard.keys, sizeof input->keyboard.keys);
+}
+
+static u32 hashBytes(u32 hash, const void* data, u32 size)
+{
+	const u8* ptr = data;
+
+	for(u32 i = 0; i < size; i++)
+		hash = (hash ^ ptr[i]) * 16777619u;
+
+	return hash;
+}
+
+u32 replay_cart_hash(const void* cart, s32 size)
+{
+	return hashBytes(2166136261u, cart, size);
+}
+
+u32 replay_frame_hash(tic_mem* memory)
+{
+	u32 hash = hashBytes(2166136261u, &memory->ram.vram, sizeof memory->ram.vram);
+
+	return hashBytes(hash, memory->samples.buffer, memory->samples.size);
+}
+
+void replay_seed(u32 seed)
+{
+	srand(seed);
+
+#if defined(__TIC_LINUX__) || defined(__TIC_MACOSX__) || defined(__TIC_ANDROID__)
+	srandom(seed);
+#endif
+}
+
+Replay* replay_create(u32 cart, u32 seed, u32 period, u32 samplerate)
+{
+	Replay* replay = calloc(1, sizeof(Replay));
+
+	if(replay)
+		replay->info = (ReplayInfo){cart, seed, 0, period, samplerate};
+
+	return replay;
+}
+
+void replay_record(Replay* replay, const tic80_input* input, tic_mem* memory)
+{
+	const tic80_input* last = &replay->last;
+	u8 changed = 0;
+
+	if(input->gamepads.data != last->gamepads.data) changed |= ChangedGamepads;
+	if(input->mouse.x != last->mouse.x || input->mouse.y != last->mouse.y || input->mouse.btns != last->mouse.btns) 
+		changed |= ChangedMouse;
+	if(input->keyboard.data != last->keyboard.data) changed |= ChangedKeyboard;
+
+	if(changed)
+	{
+		Buffer* buffer = &replay->input;
+
+		putCount(buffer, replay->same);
+		putBytes(buffer, &changed, 1);
+
+		if(changed & ChangedGamepads) putU32(buffer, input->gamepads.data);
+		if(changed & ChangedMouse) putMouse(buffer, &input->mouse);
+		if(changed & ChangedKeyboard) putBytes(buffer, input->keyboard.keys, sizeof input->keyboard.keys);
+
+		replay->same = 0;
+		replay->last = *input;
+	}
+	else replay->same++;
+
+	if(replay->info.period && replay->info.frames % replay->info.period == 0)
+		putU32(&replay->hashes, replay_frame_hash(memory));
+
+	replay->info.frames++;
+}
+
+void* replay_save(Replay* replay, u32* size)
+{
+	Buffer buffer = {0};
+
+	putBytes(&buffer, REPLAY_MAGIC, 4);
+	putU32(&buffer, REPLAY_VERSION);
+	putU32(&buffer, replay->info.cart);
+	putU32(&buffer, replay->info.seed);
+	putU32(&buffer, replay->info.frames);
+	putU32(&buffer, replay->info.period);
+	putU32(&buffer, replay->input.size);
+	putU32(&buffer, replay->hashes.size);
+	putU32(&buffer, replay->info.samplerate);
+	putBytes(&buffer, replay->input.data, replay->input.size);
+	putBytes(&buffer, replay->hashes.data, replay->hashes.size);
+
+	*size = buffer.size;
+
+	return buffer.data;
+}
+
+Replay* replay_open(const void* data, u32 size)
+{
+	const u8* ptr = data;
+
+	if(size < REPLAY_HEADER_SIZE(1) || memcmp(ptr, REPLAY_MAGIC, 4))
+		return NULL;
+
+	// version 1 had no samplerate, it was always recorded at the default one
+	u32 version = getU32(ptr + 4);
+
+	if(version < 1 || version > REPLAY_VERSION || size < REPLAY_HEADER_SIZE(version))
+		return NULL;
+
+	u32 inputSize = getU32(ptr + 24);
+	u32 hashesSize = getU32(ptr + 28);
+	u32 samplerate = version > 1 ? getU32(ptr + 32) : TIC80_SAMPLERATE;
+
+	if((u64)REPLAY_HEADER_SIZE(version) + inputSize + hashesSize > size)
+		return NULL;
+
+	Replay* replay = replay_create(getU32(ptr + 8), getU32(ptr + 12), getU32(ptr + 20), samplerate);
+
+	if(replay)
+	{
+		replay->info.frames = getU32(ptr + 16);
+
+		ptr += REPLAY_HEADER_SIZE(version);
+		putBytes(&replay->input, ptr, inputSize);
+		putBytes(&replay->hashes, ptr + inputSize, hashesSize);
+	}
+
+	return replay;
+}
+
+ReplayInfo replay_info(Replay* replay)
+{
+	return replay->info;
+}
+
+bool replay_input(Replay* replay, tic80_input* input)
+{
+	if(replay->frame >= replay->info.frames)
+		return false;
+
+	// a run of repeated input is followed by the fields that changed, past the end the input holds
+	if(replay->same) replay->same--;
+	else if(replay->pos < replay->input.size)
+	{
+		u32 same = 0;
+
+		if(!replay->counted && getCount(replay, &same) && same)
+		{
+			replay->same = same - 1;
+			replay->counted = true;
+		}
+		else
+		{
+			replay->counted = false;
+			getChanges(replay, &replay->last);
+		}
+	}
+
+	*input = replay->last;
+	replay->frame++;
+
+	return true;
+}
+
+bool replay_verify(Replay* replay, tic_mem* memory)
+{
+	u32 frame = replay->frame - 1;
+	u32 period = replay->info.period;
+
+	if(!replay->frame || !period || frame % period) 
+		return true;
+
+	u32 index = frame / period;
+
+	if((index + 1) * sizeof(u32) > replay->hashes.size)
+		return true;
+
+	return getU32(replay->hashes.data + index * sizeof(u32)) == replay_frame_hash(memory);
+}
+
+void replay_delete(Replay* replay)
+{
+	if(replay)
+	{
+		free(replay->input.data);
+		free(replay->hashes.data);
+		free(replay);
+	}
+}
@@ -0,0 +1,63 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "ticapi.h"
+
+#define REPLAY_HASH_PERIOD 10
+
+typedef struct Replay Replay;
+
+typedef struct
+{
+	u32 cart;
+	u32 seed;
+	u32 frames;
+	u32 period;
+
+	// the sound buffer is hashed, playback has to run at the recorded rate
+	u32 samplerate;
+} ReplayInfo;
+
+// a replay is the input of every frame since the cart was loaded, stored as runs of repeated
+// input and changed fields, plus a VRAM and sound hash every `period` frames
+Replay* replay_create(u32 cart, u32 seed, u32 period, u32 samplerate);
+void replay_record(Replay* replay, const tic80_input* input, tic_mem* memory);
+void* replay_save(Replay* replay, u32* size);
+
+Replay* replay_open(const void* data, u32 size);
+ReplayInfo replay_info(Replay* replay);
+
+// false once all the frames are played
+bool replay_input(Replay* replay, tic80_input* input);
+
+// call after tic80_tick of the frame replay_input returned (SCN/OVR included), false when it was hashed and doesn't match
+bool replay_verify(Replay* replay, tic_mem* memory);
+
+u32 replay_cart_hash(const void* cart, s32 size);
+u32 replay_frame_hash(tic_mem* memory);
+
+// random() and rand() feed the scripts' random generators
+void replay_seed(u32 seed);
+
+void replay_delete(Replay* replay);
@@ -0,0 +1,249 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "rewind.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// a frame is the XOR of two neighbour snapshots packed as
+// (equal bytes count, changed bytes count, changed bytes) runs with varint counts
+typedef struct Frame Frame;
+
+struct Frame
+{
+	Frame* next;
+	Frame* prev;
+
+	u32 size;
+	u8 data[];
+};
+
+struct Rewind
+{
+	Frame* first;
+	Frame* last;
+
+	u32 count;
+	u32 used;
+	u32 budget;
+
+	u32 size;
+	u8* state;
+	u8* scratch;
+	bool ready;
+};
+
+static inline u8* putCount(u8* ptr, u32 value)
+{
+	for(; value >= 0x80; value >>= 7)
+		*ptr++ = value | 0x80;
+
+	*ptr++ = value;
+
+	return ptr;
+}
+
+static inline const u8* getCount(const u8* ptr, u32* value)
+{
+	u32 result = 0;
+
+	for(s32 shift = 0; ; shift += 7)
+	{
+		u8 byte = *ptr++;
+		result |= (u32)(byte & 0x7f) << shift;
+
+		if(!(byte & 0x80)) break;
+	}
+
+	*value = result;
+
+	return ptr;
+}
+
+static u32 encode(const u8* from, const u8* to, u32 size, u8* dst)
+{
+	u8* ptr = dst;
+	u32 pos = 0;
+
+	while(pos < size)
+	{
+		u32 start = pos;
+
+		// most of the machine is untouched between frames, skip it a word at a time
+		while(pos + sizeof(u64) <= size && !memcmp(from + pos, to + pos, sizeof(u64)))
+			pos += sizeof(u64);
+
+		while(pos < size && from[pos] == to[pos]) pos++;
+
+		u32 equal = pos - start;
+
+		if(pos == size) break;
+
+		start = pos;
+
+		// a single equal byte costs more as a run than as a literal
+		while(pos < size && (from[pos] != to[pos] || (pos + 1 < size && from[pos + 1] != to[pos + 1])))
+			pos++;
+
+		ptr = putCount(ptr, equal);
+		ptr = putCount(ptr, pos - start);
+
+		for(u32 i = start; i < pos; i++)
+			*ptr++ = from[i] ^ to[i];
+	}
+
+	return (u32)(ptr - dst);
+}
+
+static void decode(const u8* src, u32 size, u8* dst)
+{
+	const u8* end = src + size;
+
+	while(src < end)
+	{
+		u32 equal, changed;
+
+		src = getCount(src, &equal);
+		src = getCount(src, &changed);
+
+		dst += equal;
+
+		for(u32 i = 0; i < changed; i++)
+			*dst++ ^= *src++;
+	}
+}
+
+static inline u32 frameSize(const Frame* frame)
+{
+	return sizeof(Frame) + frame->size;
+}
+
+static void removeFrame(Rewind* rewind, Frame* frame)
+{
+	if(frame->prev) frame->prev->next = frame->next;
+	else rewind->first = frame->next;
+
+	if(frame->next) frame->next->prev = frame->prev;
+	else rewind->last = frame->prev;
+
+	rewind->used -= frameSize(frame);
+	rewind->count--;
+
+	free(frame);
+}
+
+Rewind* rewind_create(u32 size, u32 budget)
+{
+	Rewind* rewind = (Rewind*)malloc(sizeof(Rewind));
+
+	if(rewind)
+	{
+		*rewind = (Rewind)
+		{
+			.budget = budget,
+			.size = size,
+			.state = malloc(size),
+			// worst case is a changed byte every other byte plus the counts
+			.scratch = malloc(size * 2 + 16),
+		};
+
+		if(!rewind->state || !rewind->scratch)
+		{
+			rewind_delete(rewind);
+			rewind = NULL;
+		}
+	}
+
+	return rewind;
+}
+
+void rewind_push(Rewind* rewind, const void* snapshot)
+{
+	if(!rewind->ready)
+	{
+		memcpy(rewind->state, snapshot, rewind->size);
+		rewind->ready = true;
+		return;
+	}
+
+	u32 size = encode(rewind->state, snapshot, rewind->size, rewind->scratch);
+	Frame* frame = (Frame*)malloc(sizeof(Frame) + size);
+
+	if(!frame) return;
+
+	frame->next = NULL;
+	frame->prev = rewind->last;
+	frame->size = size;
+	memcpy(frame->data, rewind->scratch, size);
+
+	if(rewind->last) rewind->last->next = frame;
+	else rewind->first = frame;
+
+	rewind->last = frame;
+	rewind->used += frameSize(frame);
+	rewind->count++;
+
+	memcpy(rewind->state, snapshot, rewind->size);
+
+	while(rewind->budget && rewind->used > rewind->budget && rewind->first)
+		removeFrame(rewind, rewind->first);
+}
+
+bool rewind_step(Rewind* rewind, void* snapshot)
+{
+	Frame* frame = rewind->last;
+
+	if(!frame) return false;
+
+	decode(frame->data, frame->size, rewind->state);
+	removeFrame(rewind, frame);
+
+	memcpy(snapshot, rewind->state, rewind->size);
+
+	return true;
+}
+
+u32 rewind_count(Rewind* rewind)
+{
+	return rewind->count;
+}
+
+void rewind_clear(Rewind* rewind)
+{
+	while(rewind->first)
+		removeFrame(rewind, rewind->first);
+
+	rewind->ready = false;
+}
+
+void rewind_delete(Rewind* rewind)
+{
+	if(rewind)
+	{
+		rewind_clear(rewind);
+
+		free(rewind->state);
+		free(rewind->scratch);
+		free(rewind);
+	}
+}
@@ -0,0 +1,41 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <tic80_types.h>
+
+typedef struct Rewind Rewind;
+
+// keeps the newest snapshot in full and the older ones as backward deltas,
+// the oldest frames are dropped once the deltas take more than `budget` bytes
+Rewind* rewind_create(u32 size, u32 budget);
+
+// snapshots must be `size` bytes, the first push only sets the starting point
+void rewind_push(Rewind* rewind, const void* snapshot);
+
+// moves one frame back and writes it to `snapshot`, false when nothing is left
+bool rewind_step(Rewind* rewind, void* snapshot);
+
+u32 rewind_count(Rewind* rewind);
+void rewind_clear(Rewind* rewind);
+void rewind_delete(Rewind* rewind);
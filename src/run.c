@@ -23,6 +23,8 @@
 #include "run.h"
 #include "console.h"
 #include "fs.h"
+#include "pmem.h"
+#include "tracing.h"
 #include "ext/md5.h"
 #include <time.h>
 
@@ -91,19 +93,31 @@ static void tick(Run* run)
 		return;
 
 	run->tic->api.tick(run->tic, &run->tickData);
+	run->console->flush(run->console);
 
 	enum {Size = sizeof(tic_persistent)};
 
+	TRACE_BEGIN("pmem");
+
 	if(run->tickData.syncPMEM)
-	{		
-		fsSaveRootFile(run->console->fs, run->saveid, &run->tic->ram.persistent, Size, true);
+	{
+		pmem_update(run->pmem, run->console->fs, run->saveid, &run->tic->ram.persistent, Size);
 		run->tickData.syncPMEM = false;
 	}
 
+	pmem_tick(run->pmem, getConfig()->pmemInterval);
+
+	TRACE_END("pmem");
+
 	if(run->exit)
 		setStudioMode(TIC_CONSOLE_MODE);
 }
 
+static void flush(Run* run)
+{
+	pmem_flush(run->pmem);
+}
+
 static void processDoFile(void* data, char* dst)
 {
 	Run* run = (Run*)data;
@@ -167,11 +181,20 @@ static bool forceExit(void* data)
 
 void initRun(Run* run, Console* console, tic_mem* tic)
 {
+	PMem* pmem = run->pmem ? run->pmem : pmem_create();
+	tic_profile* profile = run->profile;
+
+	// pending pmem of the previous run has to be on disk before it's loaded again
+	pmem_flush(pmem);
+
 	*run = (Run)
 	{
 		.tic = tic,
 		.console = console,
 		.tick = tick,
+		.flush = flush,
+		.pmem = pmem,
+		.profile = profile,
 		.exit = false,
 		.tickData = 
 		{
@@ -188,6 +211,15 @@ void initRun(Run* run, Console* console, tic_mem* tic)
 		},
 	};
 
+	if(profile && profile->period)
+	{
+		profile->samples = 0;
+		memset(profile->lines, 0, sizeof profile->lines);
+		memset(profile->functions, 0, sizeof profile->functions);
+
+		run->tickData.profile = profile;
+	}
+
 	{
 		enum {Size = sizeof(tic_persistent)};
 		memset(&run->tic->ram.persistent, 0, Size);
@@ -207,3 +239,11 @@ void initRun(Run* run, Console* console, tic_mem* tic)
 
 	getSystem()->preseed();
 }
+
+void freeRun(Run* run)
+{
+	if(run->pmem)
+		pmem_delete(run->pmem);
+
+	free(run->profile);
+}
@@ -36,7 +36,14 @@ struct Run
 	
 	char saveid[TIC_SAVEID_SIZE];
 
+	struct PMem* pmem;
+
+	// samples of the last run, kept until the next one
+	tic_profile* profile;
+
 	void(*tick)(Run*);
+	void(*flush)(Run*);
 };
 
 void initRun(Run*, struct Console*, tic_mem*);
+void freeRun(Run*);
@@ -181,7 +181,10 @@ static void drawVolumeStereo(Sfx* sfx, s32 x, s32 y)
 			showTooltip("left stereo");
 
 			if(checkMouseClick(&rect, tic_mouse_left))
+			{
 				effect->stereo_left = ~effect->stereo_left;
+				history_add(sfx->history);
+			}
 		}
 
 		tic->api.text(tic, "L", rect.x, rect.y, effect->stereo_left ? hover ? tic_color_14 : tic_color_15 : tic_color_5, true);
@@ -199,7 +202,10 @@ static void drawVolumeStereo(Sfx* sfx, s32 x, s32 y)
 			showTooltip("right stereo");
 
 			if(checkMouseClick(&rect, tic_mouse_left))
+			{
 				effect->stereo_right = ~effect->stereo_right;
+				history_add(sfx->history);
+			}
 		}
 
 		tic->api.text(tic, "R", rect.x, rect.y, effect->stereo_right ? hover ? tic_color_14 : tic_color_15 : tic_color_5, true);
@@ -228,7 +234,10 @@ static void drawArppeggioSwitch(Sfx* sfx, s32 x, s32 y)
 			showTooltip("up/down arpeggio");
 
 			if(checkMouseClick(&rect, tic_mouse_left))
+			{
 				effect->reverse = ~effect->reverse;
+				history_add(sfx->history);
+			}
 		}
 
 		tic->api.text(tic, Label, rect.x, rect.y, effect->reverse ? tic_color_5 : hover ? tic_color_14 : tic_color_15, true);
@@ -257,7 +266,10 @@ static void drawPitchSwitch(Sfx* sfx, s32 x, s32 y)
 			showTooltip("x16 pitch");
 
 			if(checkMouseClick(&rect, tic_mouse_left))
+			{
 				effect->pitch16x = ~effect->pitch16x;
+				history_add(sfx->history);
+			}
 		}
 
 		tic->api.text(tic, Label, rect.x, rect.y, effect->pitch16x ? tic_color_5 : hover ? tic_color_14 : tic_color_15, true);
@@ -516,7 +528,12 @@ static void processKeyboard(Sfx* sfx)
 
 	if(keyboardButton >= 0)
 	{
-		effect->note = keyboardButton;
+		if(effect->note != keyboardButton)
+		{
+			effect->note = keyboardButton;
+			history_add(sfx->history);
+		}
+
 		sfx->play.active = true;
 	}
 
@@ -970,4 +987,6 @@ void initSfx(Sfx* sfx, tic_mem* tic, tic_sfx* src)
 		.history = history_create(src, sizeof(tic_sfx)),
 		.event = onStudioEvent,
 	};
+
+	history_budget(sfx->history, getConfig()->undoBudget);
 }
@@ -22,6 +22,7 @@
 
 #include "sprite.h"
 #include "history.h"
+#include "fill.h"
 
 #define CANVAS_SIZE (64)
 #define PALETTE_CELL_SIZE 8
@@ -251,25 +252,66 @@ static void processSelectCanvasMouse(Sprite* sprite, s32 x, s32 y)
 	}
 }
 
-static void floodFill(Sprite* sprite, s32 l, s32 t, s32 r, s32 b, s32 x, s32 y, u8 color, u8 fill)
+typedef struct
 {
-	if(getSheetPixel(sprite, x, y) == color)
-	{
-		setSheetPixel(sprite, x, y, fill);
+	Sprite* sprite;
+	u8 color;
+	u8 fill;
+} SpriteFill;
 
-		if(x > l) floodFill(sprite, l, t, r, b, x-1, y, color, fill);
-		if(x < r) floodFill(sprite, l, t, r, b, x+1, y, color, fill);
-		if(y > t) floodFill(sprite, l, t, r, b, x, y-1, color, fill);
-		if(y < b) floodFill(sprite, l, t, r, b, x, y+1, color, fill);
-	}
+static bool matchSheetPixel(void* data, s32 x, s32 y)
+{
+	SpriteFill* fill = data;
+	return getSheetPixel(fill->sprite, x, y) == fill->color;
 }
 
-static void replaceColor(Sprite* sprite, s32 l, s32 t, s32 r, s32 b, s32 x, s32 y, u8 color, u8 fill)
+static void fillSheetPixels(void* data, s32 x, s32 y, s32 width)
 {
-	for(s32 sy = t; sy <= b; sy++)
-		for(s32 sx = l; sx <= r; sx++)
-			if(getSheetPixel(sprite, sx, sy) == color)
-				setSheetPixel(sprite, sx, sy, fill);
+	SpriteFill* fill = data;
+
+	for(s32 i = 0; i < width; i++)
+		setSheetPixel(fill->sprite, x + i, y, fill->fill);
+}
+
+static void floodFill(Sprite* sprite, s32 l, s32 t, s32 r, s32 b, s32 x, s32 y, u8 color, u8 fill)
+{
+	if(!flood_fill(&(tic_rect){l, t, r - l + 1, b - t + 1}, x, y, matchSheetPixel, fillSheetPixels, &(SpriteFill){sprite, color, fill}))
+		showPopupMessage("FILL STOPPED, OUT OF MEMORY :(");
+}
+
+// the canvas is made of whole tiles, so every tile row is a 32-bit word of eight 4-bit pixels
+// and the pixels of `color` are replaced at once with a zero nibble test on (row ^ color)
+static void replaceColor(Sprite* sprite, s32 l, s32 t, s32 r, s32 b, u8 color, u8 fill)
+{
+	enum
+	{
+		SheetCols = TIC_SPRITESHEET_SIZE / TIC_SPRITESIZE,
+		RowSize = TIC_SPRITESIZE * TIC_PALETTE_BPP / BITS_IN_BYTE,
+	};
+
+	const u32 Nibbles = 0x11111111;
+	const u32 from = color * Nibbles, to = fill * Nibbles;
+
+	tic_tile* tiles = sprite->src->data + (sprite->index >= TIC_BANK_SPRITES ? TIC_BANK_SPRITES : 0);
+
+	for(s32 y = t; y <= b; y++)
+		for(s32 x = l; x <= r; x += TIC_SPRITESIZE)
+		{
+			u8* ptr = tiles[x / TIC_SPRITESIZE + y / TIC_SPRITESIZE * SheetCols].data + y % TIC_SPRITESIZE * RowSize;
+
+			u32 row;
+			memcpy(&row, ptr, sizeof row);
+
+			u32 diff = row ^ from;
+			u32 mask = ~(((diff & 0x77777777) + 0x77777777) | diff) & 0x88888888;
+
+			if(mask)
+			{
+				mask = (mask >> 3) * 0xf;
+				row = (row & ~mask) | (to & mask);
+				memcpy(ptr, &row, sizeof row);
+			}
+		}
 }
 
 static void processFillCanvasMouse(Sprite* sprite, s32 x, s32 y, s32 l, s32 t)
@@ -304,7 +346,7 @@ static void processFillCanvasMouse(Sprite* sprite, s32 x, s32 y, s32 l, s32 t)
 			if(color != fill)
 			{
 				tic->api.key(tic, tic_key_ctrl)
-					? replaceColor(sprite, l, t, l + sprite->size-1, t + sprite->size-1, sx, sy, color, fill)
+					? replaceColor(sprite, l, t, l + sprite->size-1, t + sprite->size-1, color, fill)
 					: floodFill(sprite, l, t, l + sprite->size-1, t + sprite->size-1, sx, sy, color, fill);
 			}
 
@@ -1758,4 +1800,6 @@ void initSprite(Sprite* sprite, tic_mem* tic, tic_tiles* src)
 		.overline = overline,
 		.scanline = scanline,
 	};
+
+	history_budget(sprite->history, getConfig()->undoBudget);
 }
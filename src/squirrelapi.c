@@ -1146,6 +1146,47 @@ static SQInteger squirrel_print(HSQUIRRELVM vm)
 	return 0;
 }
 
+static SQInteger squirrel_textwidth(HSQUIRRELVM vm)
+{
+	SQInteger top = sq_gettop(vm);
+
+	if(top >= 2) 
+	{
+		tic_mem* memory = (tic_mem*)getSquirrelMachine(vm);
+
+		bool fixed = false;
+		bool alt = false;
+		s32 scale = 1;
+
+		const char* text = printString(vm, 2);
+
+		if(top >= 3)
+		{
+			SQBool b = SQFalse;
+			sq_getbool(vm, 3, &b);
+			fixed = (b != SQFalse);
+
+			if(top >= 4)
+			{
+				scale = getSquirrelNumber(vm, 4);
+
+				if(top >= 5)
+				{
+					SQBool b = SQFalse;
+					sq_getbool(vm, 5, &b);
+					alt = (b != SQFalse);
+				}
+			}
+		}
+
+		sq_pushinteger(vm, memory->api.text_width(memory, text ? text : "nil", fixed, scale, alt));
+
+		return 1;
+	}
+
+	return 0;
+}
+
 static SQInteger squirrel_trace(HSQUIRRELVM vm)
 {
 	SQInteger top = sq_gettop(vm);
@@ -1272,7 +1313,7 @@ static const SQFUNCTION ApiFunc[] =
 	squirrel_mset, squirrel_peek, squirrel_poke, squirrel_peek4, squirrel_poke4, squirrel_memcpy, 
 	squirrel_memset, squirrel_trace, squirrel_pmem, squirrel_time, squirrel_exit, squirrel_font, squirrel_mouse, 
 	squirrel_circ, squirrel_circb, squirrel_tri, squirrel_textri, squirrel_clip, squirrel_music, squirrel_sync, squirrel_reset,
-	squirrel_key, squirrel_keyp
+	squirrel_key, squirrel_keyp, squirrel_textwidth
 };
 
 STATIC_ASSERT(api_func, COUNT_OF(ApiKeywords) == COUNT_OF(ApiFunc));
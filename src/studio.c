@@ -36,6 +36,9 @@
 #include "dialog.h"
 #include "menu.h"
 #include "surf.h"
+#include "recorder.h"
+#include "rewind.h"
+#include "tracing.h"
 
 #include "fs.h"
 
@@ -49,8 +52,8 @@
 #include <lauxlib.h>
 #include <lualib.h>
 
-#define FRAME_SIZE (TIC80_FULLWIDTH * TIC80_FULLHEIGHT * sizeof(u32))
 #define POPUP_DUR (TIC80_FRAMERATE*2)
+#define REWIND_BUDGET (8 * 1024 * 1024)
 
 #if defined(TIC80_PRO)
 #define TIC_EDITOR_BANKS (TIC_BANKS)
@@ -63,6 +66,39 @@ typedef struct
 	u8 data[16];
 } CartHash;
 
+typedef enum
+{
+	CART_TILES,
+	CART_MAP,
+	CART_SFX,
+	CART_MUSIC,
+	CART_PALETTE,
+	CART_FLAGS,
+	CART_BANK_SECTIONS,
+
+	CART_CODE = CART_BANK_SECTIONS,
+	CART_COVER,
+} CartSection;
+
+#define CART_CHUNKS (TIC_BANKS * CART_BANK_SECTIONS + 2)
+
+// a cart section with the hash it had when loaded or saved and the editor
+// history generation it was last compared at
+typedef struct
+{
+	CartSection section;
+	s32 bank;
+	u32 stamp;
+	bool changed;
+	CartHash hash;
+} CartChunk;
+
+enum
+{
+	WATCH_PROJECT,
+	WATCH_CODE,
+};
+
 typedef struct
 {
 	bool down;
@@ -91,7 +127,8 @@ static struct
 
 	struct
 	{
-		CartHash hash;
+		CartChunk chunks[CART_CHUNKS];
+		bool touched;
 		u64 mdate;
 	}cart;
 
@@ -142,12 +179,31 @@ static struct
 	{
 		bool record;
 
-		u32* buffer;
+		Recorder* recorder;
 		s32 frames;
 		s32 frame;
 
 	} video;
 
+	struct
+	{
+		Rewind* frames;
+		void* state;
+		u32 size;
+	} rewind;
+
+	struct
+	{
+		tic80_input input;
+
+		// frames since the last activity and frames the editors didn't see
+		s32 frames;
+		u32 ticks;
+
+		// something changed the studio without an input, a watched file, a finished request or a cart edit
+		bool wake;
+	} idle;
+
 	struct
 	{
 		Code* 	code;
@@ -170,6 +226,7 @@ static struct
 	};
 
 	FileSystem* fs;
+	FileWatcher* watcher;
 
 	bool missedFrame;
 
@@ -222,7 +279,7 @@ static struct
 	.video =
 	{
 		.record = false,
-		.buffer = NULL,
+		.recorder = NULL,
 		.frames = 0,
 	},
 
@@ -850,7 +907,7 @@ ClipboardEvent getClipboardEvent()
 	return TIC_CLIPBOARD_NONE;
 }
 
-static void showPopupMessage(const char* text)
+void showPopupMessage(const char* text)
 {
 	impl.popup.counter = POPUP_DUR;
 	strcpy(impl.popup.message, text);
@@ -895,6 +952,69 @@ static void initWorldMap()
 static void initRunMode()
 {
 	initRun(impl.run, impl.console, impl.studio.tic);
+
+	if(impl.rewind.frames)
+		rewind_clear(impl.rewind.frames);
+}
+
+static void recordRewindFrame()
+{
+	tic80* tic = (tic80*)impl.tic80local;
+
+	if(!impl.rewind.frames)
+	{
+		impl.rewind.size = tic80_state_size(tic);
+		impl.rewind.state = malloc(impl.rewind.size);
+		impl.rewind.frames = rewind_create(impl.rewind.size, REWIND_BUDGET);
+	}
+
+	if(impl.rewind.frames && impl.rewind.state && tic80_save_state(tic, impl.rewind.state, impl.rewind.size))
+		rewind_push(impl.rewind.frames, impl.rewind.state);
+}
+
+bool studioRewind(s32 frames)
+{
+	tic_mem* tic = impl.studio.tic;
+
+	if(!impl.rewind.frames || !rewind_count(impl.rewind.frames))
+		return false;
+
+	for(s32 i = 0; i < frames && rewind_step(impl.rewind.frames, impl.rewind.state); i++);
+
+	// the game sits paused behind the menu, the restored frame becomes the paused one
+	tic->api.resume(tic);
+	tic80_load_state((tic80*)impl.tic80local, impl.rewind.state, impl.rewind.size);
+	tic->api.pause(tic);
+
+	// no reset, its cart palette would replace the rewound one under the menu background,
+	// the menu only needs the whole screen and silence
+	tic->api.clip(tic, 0, 0, TIC80_WIDTH, TIC80_HEIGHT);
+	tic->api.music(tic, -1, 0, 0, false);
+
+	for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+		tic->api.sfx_stop(tic, i);
+
+	showPopupMessage("RAM REWOUND, SCRIPT VARS KEPT :|");
+
+	return true;
+}
+
+void setProfilePeriod(u32 period)
+{
+	Run* run = impl.run;
+
+	if(period && !run->profile)
+		run->profile = calloc(1, sizeof(tic_profile));
+
+	if(run->profile)
+		run->profile->period = period;
+}
+
+const tic_profile* getProfile()
+{
+	const tic_profile* profile = impl.run->profile;
+
+	return profile && profile->samples ? profile : NULL;
 }
 
 static void initSurfMode()
@@ -951,7 +1071,12 @@ void setStudioMode(EditorMode mode)
 		EditorMode prev = impl.mode;
 
 		if(prev == TIC_RUN_MODE)
+		{
+			// sync() may have written any section of the cart
+			studioCartTouched();
+			impl.run->flush(impl.run);
 			impl.studio.tic->api.pause(impl.studio.tic);
+		}
 
 		if(mode != TIC_RUN_MODE)
 			impl.studio.tic->api.reset(impl.studio.tic);
@@ -1002,6 +1127,7 @@ void changeStudioMode(s32 dir)
 
 static void showGameMenu()
 {
+	impl.run->flush(impl.run);
 	impl.studio.tic->api.pause(impl.studio.tic);
 	impl.studio.tic->api.reset(impl.studio.tic);
 
@@ -1113,14 +1239,101 @@ static void initModules()
 	initWorldMap();
 }
 
+static const void* getChunkData(const tic_cartridge* cart, const CartChunk* chunk, s32* size)
+{
+	const tic_bank* bank = &cart->banks[chunk->bank];
+
+	switch(chunk->section)
+	{
+	case CART_TILES: 	*size = TIC_SPRITES * sizeof(tic_tile); return bank->tiles.data;
+	case CART_MAP: 		*size = sizeof(tic_map); return &bank->map;
+	case CART_SFX: 		*size = sizeof(tic_sfx); return &bank->sfx;
+	case CART_MUSIC: 	*size = sizeof(tic_music); return &bank->music;
+	case CART_PALETTE: 	*size = sizeof(tic_palette); return &bank->palette;
+	case CART_FLAGS: 	*size = sizeof(tic_flags); return &bank->flags;
+	case CART_CODE: 	*size = (s32)strlen(cart->code.data); return cart->code.data;
+	case CART_COVER: 	*size = sizeof cart->cover.size + MIN(MAX(cart->cover.size, 0), (s32)sizeof cart->cover.data); return &cart->cover;
+	default: 			*size = 0; return NULL;
+	}
+}
+
+// sections edited only through a history change their generation with every edit,
+// the rest are cheap enough to hash on every check
+static bool getChunkStamp(const CartChunk* chunk, u32* stamp)
+{
+	if(chunk->bank >= TIC_EDITOR_BANKS)
+		return false;
+
+	switch(chunk->section)
+	{
+	case CART_TILES: 	*stamp = history_generation(impl.editor[chunk->bank].sprite->history); return true;
+	case CART_MAP: 		*stamp = history_generation(impl.editor[chunk->bank].map->history); return true;
+	case CART_SFX: 		*stamp = history_generation(impl.editor[chunk->bank].sfx->history); return true;
+	case CART_MUSIC: 	*stamp = history_generation(impl.editor[chunk->bank].music->history); return true;
+	case CART_CODE:
+		if(impl.console->codeLiveReload.active)
+			return false;
+
+		*stamp = 0;
+		for(s32 i = 0; i < TIC_EDITOR_BANKS; i++)
+			*stamp = MAX(*stamp, history_generation(impl.editor[i].code->history));
+
+		return true;
+	default: return false;
+	}
+}
+
+static void hashChunk(const tic_cartridge* cart, const CartChunk* chunk, CartHash* hash)
+{
+	s32 size = 0;
+	const void* data = getChunkData(cart, chunk, &size);
+
+	md5(data, size, hash->data);
+}
+
+static void copyChunk(tic_cartridge* dst, const tic_cartridge* src, const CartChunk* chunk)
+{
+	switch(chunk->section)
+	{
+	case CART_CODE: 	memcpy(&dst->code, &src->code, sizeof(tic_code)); break;
+	case CART_COVER: 	memcpy(&dst->cover, &src->cover, sizeof(tic_cover_image)); break;
+	default:
+		{
+			s32 size = 0;
+			void* data = (void*)getChunkData(dst, chunk, &size);
+			memcpy(data, getChunkData(src, chunk, &size), size);
+		}
+	}
+}
+
 static void updateHash()
 {
-	md5(&impl.studio.tic->cart, sizeof(tic_cartridge), impl.cart.hash.data);
+	for(s32 i = 0; i < CART_CHUNKS; i++)
+	{
+		CartChunk* chunk = &impl.cart.chunks[i];
+
+		*chunk = (CartChunk)
+		{
+			.section = i < TIC_BANKS * CART_BANK_SECTIONS ? i % CART_BANK_SECTIONS : CART_CODE + i - TIC_BANKS * CART_BANK_SECTIONS,
+			.bank = i < TIC_BANKS * CART_BANK_SECTIONS ? i / CART_BANK_SECTIONS : 0,
+		};
+
+		getChunkStamp(chunk, &chunk->stamp);
+		hashChunk(&impl.studio.tic->cart, chunk, &chunk->hash);
+	}
+
+	impl.cart.touched = false;
 }
 
 static void updateMDate()
 {
 	impl.cart.mdate = fsMDate(impl.console->fs, impl.console->romName);
+
+#if defined(TIC80_PRO)
+	if(strlen(impl.console->romName))
+		fsWatchFile(impl.console->fs, impl.watcher, impl.console->romName, WATCH_PROJECT);
+	else fsUnwatch(impl.watcher, WATCH_PROJECT);
+#endif
 }
 
 static void updateTitle()
@@ -1149,12 +1362,132 @@ void studioRomLoaded()
 	updateMDate();
 }
 
+static bool isRunning()
+{
+	return impl.mode == TIC_RUN_MODE
+		|| (impl.mode == TIC_DIALOG_MODE && impl.dialogMode == TIC_RUN_MODE);
+}
+
+// the running cart keeps its RAM, the new code only redefines what it declares
+static void hotSwapCode()
+{
+	tic_mem* tic = impl.studio.tic;
+	const tic_script_config* config = tic->api.get_script_config(tic);
+
+	if(config->eval)
+		config->eval(tic, tic->cart.code.data);
+}
+
+void studioRomReloaded(const tic_cartridge* cart)
+{
+	tic_mem* tic = impl.studio.tic;
+	bool code = false, map = false;
+
+	for(s32 i = 0; i < CART_CHUNKS; i++)
+	{
+		const CartChunk* chunk = &impl.cart.chunks[i];
+		CartHash prev, next;
+
+		hashChunk(&tic->cart, chunk, &prev);
+		hashChunk(cart, chunk, &next);
+
+		if(memcmp(prev.data, next.data, sizeof(CartHash)) == 0)
+			continue;
+
+		copyChunk(&tic->cart, cart, chunk);
+
+		s32 bank = chunk->bank;
+		if(bank >= TIC_EDITOR_BANKS)
+			continue;
+
+		switch(chunk->section)
+		{
+		case CART_TILES: 	initSprite(impl.editor[bank].sprite, tic, &tic->cart.banks[bank].tiles); break;
+		case CART_MAP: 		initMap(impl.editor[bank].map, tic, &tic->cart.banks[bank].map); map = true; break;
+		case CART_SFX: 		initSfx(impl.editor[bank].sfx, tic, &tic->cart.banks[bank].sfx); break;
+		case CART_MUSIC: 	initMusic(impl.editor[bank].music, tic, &tic->cart.banks[bank].music); break;
+		case CART_CODE: 	code = true; break;
+		default: break;
+		}
+	}
+
+	if(code)
+	{
+		for(s32 i = 0; i < TIC_EDITOR_BANKS; i++)
+			initCode(impl.editor[i].code, tic, &tic->cart.code);
+
+		if(isRunning())
+			hotSwapCode();
+	}
+
+	if(map)
+		initWorldMap();
+
+	updateHash();
+	updateMDate();
+}
+
 bool studioCartChanged()
 {
-	CartHash hash;
-	md5(&impl.studio.tic->cart, sizeof(tic_cartridge), hash.data);
+	bool changed = false;
+
+	for(s32 i = 0; i < CART_CHUNKS; i++)
+	{
+		CartChunk* chunk = &impl.cart.chunks[i];
+		u32 stamp = 0;
+
+		if(!getChunkStamp(chunk, &stamp) || stamp != chunk->stamp || impl.cart.touched)
+		{
+			CartHash hash;
+			hashChunk(&impl.studio.tic->cart, chunk, &hash);
+
+			chunk->changed = memcmp(hash.data, chunk->hash.data, sizeof(CartHash)) != 0;
+			chunk->stamp = stamp;
+		}
+
+		changed |= chunk->changed;
+	}
 
-	return memcmp(hash.data, impl.cart.hash.data, sizeof(CartHash)) != 0;
+	impl.cart.touched = false;
+
+	return changed;
+}
+
+void studioCartTouched()
+{
+	impl.cart.touched = true;
+	impl.idle.wake = true;
+}
+
+typedef struct
+{
+	HttpGetCallback callback;
+	void* calldata;
+} StudioRequest;
+
+static void onStudioRequest(const HttpGetData* data)
+{
+	StudioRequest* request = (StudioRequest*)data->calldata;
+
+	HttpGetData result = *data;
+	result.calldata = request->calldata;
+
+	impl.idle.wake = true;
+	request->callback(&result);
+
+	free(request);
+}
+
+void studioHttpGet(const char* url, HttpGetCallback callback, void* calldata)
+{
+	StudioRequest* request = (StudioRequest*)malloc(sizeof(StudioRequest));
+
+	if(request)
+	{
+		*request = (StudioRequest){callback, calldata};
+		impl.system->httpGet(url, onStudioRequest, request);
+	}
+	else callback(&(HttpGetData){.status = HttpGetError, .url = url, .calldata = calldata});
 }
 
 tic_key* getKeymap()
@@ -1260,26 +1593,46 @@ static void onVideoExported(GetResult result, void* data)
 		showPopupMessage("GIF EXPORTED :)");
 }
 
+static void getVideoPath(char* path)
+{
+	fsGetRootFilePath(impl.fs, TIC_LOCAL "screen.gif", path);
+}
+
 static void stopVideoRecord()
 {
-	if(impl.video.buffer)
+	if(impl.video.recorder)
 	{
-		{
-			s32 size = 0;
-			u8* data = malloc(FRAME_SIZE * impl.video.frame);
+		char path[FILENAME_MAX];
+		getVideoPath(path);
 
-			gif_write_animation(data, &size, TIC80_FULLWIDTH, TIC80_FULLHEIGHT, (const u8*)impl.video.buffer, impl.video.frame, TIC80_FRAMERATE, getConfig()->gifScale);
+		s32 size = 0;
+		void* data = recorder_close(impl.video.recorder) ? fsReadFile(path, &size) : NULL;
 
+		if(data)
 			fsGetFileData(onVideoExported, "screen.gif", data, size, DEFAULT_CHMOD, NULL);
-		}
+		else onVideoExported(FS_FILE_NOT_DOWNLOADED, NULL);
 
-		free(impl.video.buffer);
-		impl.video.buffer = NULL;
+		impl.video.recorder = NULL;
 	}
 
 	impl.video.record = false;
 }
 
+static void startRecorder(s32 frames)
+{
+	char path[FILENAME_MAX];
+	getVideoPath(path);
+
+	impl.video.recorder = recorder_create(path, getConfig()->gifScale);
+
+	if(impl.video.recorder)
+	{
+		impl.video.record = true;
+		impl.video.frames = frames;
+		impl.video.frame = 0;
+	}
+}
+
 #if !defined(__EMSCRIPTEN__)
 
 static void startVideoRecord()
@@ -1288,31 +1641,15 @@ static void startVideoRecord()
 	{
 		stopVideoRecord();
 	}
-	else
-	{
-		impl.video.frames = getConfig()->gifLength * TIC80_FRAMERATE;
-		impl.video.buffer = malloc(FRAME_SIZE * impl.video.frames);
-
-		if(impl.video.buffer)
-		{
-			impl.video.record = true;
-			impl.video.frame = 0;
-		}
-	}
+	else startRecorder(getConfig()->gifLength * TIC80_FRAMERATE);
 }
 
 #endif
 
 static void takeScreenshot()
 {
-	impl.video.frames = 1;
-	impl.video.buffer = malloc(FRAME_SIZE);
-
-	if(impl.video.buffer)
-	{
-		impl.video.record = true;
-		impl.video.frame = 0;
-	}
+	if(!impl.video.record)
+		startRecorder(1);
 }
 
 static inline bool keyWasPressedOnce(s32 key)
@@ -1422,43 +1759,70 @@ static void reloadConfirm(bool yes, void* data)
 
 #endif
 
-static void updateStudioProject()
+static void reloadProject()
 {
 #if defined(TIC80_PRO)
 
 	if(impl.mode != TIC_START_MODE)
 	{
-		Console* console = impl.console;
-
-		u64 mdate = fsMDate(console->fs, console->romName);
-
-		if(impl.cart.mdate && mdate > impl.cart.mdate)
+		if(studioCartChanged())
 		{
-			if(studioCartChanged())
+			static const char* Rows[] =
 			{
-				static const char* Rows[] =
-				{
-					"",
-					"CART HAS CHANGED!",
-					"",
-					"DO YOU WANT",
-					"TO RELOAD IT?"
-				};
-
-				showDialog(Rows, COUNT_OF(Rows), reloadConfirm, NULL);
-			}
-			else console->updateProject(console);						
+				"",
+				"CART HAS CHANGED!",
+				"",
+				"DO YOU WANT",
+				"TO RELOAD IT?"
+			};
+
+			showDialog(Rows, COUNT_OF(Rows), reloadConfirm, NULL);
 		}
+		else impl.console->updateProject(impl.console);
 	}
 
 #endif
+}
+
+// focus hook, there is no event to go by so the file date decides
+static void updateStudioProject()
+{
+#if defined(TIC80_PRO)
+
+	u64 mdate = fsMDate(impl.console->fs, impl.console->romName);
+
+	if(impl.cart.mdate && mdate > impl.cart.mdate)
+		reloadProject();
+
+#endif
+}
+
+static void reloadCode()
+{
+	Code* code = impl.editor[impl.bank.index.code].code;
+	impl.console->codeLiveReload.reload(impl.console, code->src);
+
+	if(code->update)
+		code->update(code);
+
+	if(isRunning())
+		hotSwapCode();
+}
+
+static void processWatcher()
+{
+	s32 id = 0;
+
+	while(fsWatcherEvent(impl.watcher, &id))
 	{
-		Code* code = impl.editor[impl.bank.index.code].code;
-		impl.console->codeLiveReload.reload(impl.console, code->src);
-		if(impl.console->codeLiveReload.active && code->update)
-			code->update(code);
-	}
+		impl.idle.wake = true;
 
+		switch(id)
+		{
+		case WATCH_PROJECT: reloadProject(); break;
+		case WATCH_CODE: 	reloadCode(); break;
+		}
+	}
 }
 
 static void drawRecordLabel(u32* frame, s32 sx, s32 sy, const u32* color)
@@ -1517,8 +1881,9 @@ static void recordFrame(u32* pixels)
 	{
 		if(impl.video.frame < impl.video.frames)
 		{
-			tic_rect rect = {0, 0, TIC80_FULLWIDTH, TIC80_FULLHEIGHT};
-			screen2buffer(impl.video.buffer + (TIC80_FULLWIDTH*TIC80_FULLHEIGHT) * impl.video.frame, pixels, rect);
+			TRACE_BEGIN("gif");
+			recorder_frame(impl.video.recorder, pixels);
+			TRACE_END("gif");
 
 			if(impl.video.frame % TIC80_FRAMERATE < TIC80_FRAMERATE / 2)
 			{
@@ -1553,7 +1918,7 @@ static void drawPopup()
 
 		impl.studio.tic->api.rect(impl.studio.tic, 0, anim, TIC80_WIDTH, TIC_FONT_HEIGHT+1, tic_color_2);
 		impl.studio.tic->api.text(impl.studio.tic, impl.popup.message, 
-			(s32)(TIC80_WIDTH - strlen(impl.popup.message)*TIC_FONT_WIDTH)/2,
+			(TIC80_WIDTH - impl.studio.tic->api.text_width(impl.studio.tic, impl.popup.message, false, 1, false))/2,
 			anim + 1, tic_color_12, false);
 	}
 }
@@ -1638,6 +2003,9 @@ static void renderStudio()
 		memset(tic->ram.registers, 0, sizeof tic->ram.registers);
 
 	impl.studio.tic->api.tick_end(impl.studio.tic);
+
+	if(impl.mode == TIC_RUN_MODE)
+		recordRewindFrame();
 }
 
 static void updateSystemFont()
@@ -1736,16 +2104,101 @@ static void processMouseStates()
 	}
 }
 
+static bool isSoundActive()
+{
+	tic_mem* tic = impl.studio.tic;
+
+	if(tic->ram.sound_state.flag.music_state != tic_music_stop)
+		return true;
+
+	for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+		if(tic->ram.registers[i].volume)
+			return true;
+
+	return false;
+}
+
+static bool isStudioIdle()
+{
+	const StudioConfig* config = getConfig();
+	const tic80_input* input = &impl.studio.tic->ram.input;
+
+	bool active = config->idleDelay <= 0
+		|| impl.idle.wake
+		|| impl.popup.counter > 0
+		|| impl.video.record
+		|| input->keyboard.data || input->gamepads.data || input->mouse.btns
+		|| memcmp(input, &impl.idle.input, sizeof(tic80_input))
+		|| isSoundActive();
+
+	// carts, menus and animated screens always run at full rate
+	switch(impl.mode)
+	{
+	case TIC_CONSOLE_MODE:
+	case TIC_CODE_MODE:
+	case TIC_SPRITE_MODE:
+	case TIC_MAP_MODE:
+	case TIC_WORLD_MODE:
+	case TIC_SFX_MODE:
+	case TIC_MUSIC_MODE:
+		break;
+	default:
+		active = true;
+	}
+
+	impl.idle.input = *input;
+	impl.idle.frames = active ? 0 : impl.idle.frames + 1;
+	impl.idle.wake = false;
+
+	if(impl.idle.frames <= config->idleDelay)
+		return false;
+
+	return config->idleRate <= 0 || impl.idle.frames % config->idleRate;
+}
+
+static void advanceEditorTicks(u32 ticks)
+{
+	// keeps cursor blink and selection animations at wall-clock speed
+	switch(impl.mode)
+	{
+	case TIC_CONSOLE_MODE:	impl.console->tickCounter += ticks; break;
+	case TIC_CODE_MODE:		impl.editor[impl.bank.index.code].code->tickCounter += ticks; break;
+	case TIC_SPRITE_MODE:	impl.editor[impl.bank.index.sprites].sprite->tickCounter += ticks; break;
+	case TIC_MAP_MODE:		impl.editor[impl.bank.index.map].map->tickCounter += ticks; break;
+	default: break;
+	}
+}
+
 static void studioTick()
 {
+	tic_mem* tic = impl.studio.tic;
+
+	// file changes apply even while the studio idles, and wake it up to show them
+	processWatcher();
+
+	impl.studio.idle = isStudioIdle();
+
+	if(impl.studio.idle)
+	{
+		impl.studio.skipped++;
+		impl.idle.ticks++;
+
+		memset(tic->samples.buffer, 0, tic->samples.size);
+		return;
+	}
+
+	if(impl.idle.ticks)
+	{
+		advanceEditorTicks(impl.idle.ticks);
+		impl.idle.ticks = 0;
+	}
+
 	processShortcuts();
 	processMouseStates();
 	processGamepadMapping();
 
 	renderStudio();
 
-	tic_mem* tic = impl.studio.tic;
-	
 	{
 		tic_scanline scanline = NULL;
 		tic_overline overline = NULL;
@@ -1790,12 +2243,14 @@ static void studioTick()
 
 static void studioClose()
 {
+	tracing_stop();
+
 	free((void*)getConfig()->crtShader);
 
 	{
 		for(s32 i = 0; i < TIC_EDITOR_BANKS; i++)
 		{
-			free(impl.editor[i].code);
+			freeCode(impl.editor[i].code);
 			free(impl.editor[i].sprite);
 			free(impl.editor[i].map);
 			free(impl.editor[i].sfx);
@@ -1803,8 +2258,12 @@ static void studioClose()
 		}
 
 		free(impl.start);
+		freeConsole(impl.console);
 		free(impl.console);
+
+		freeRun(impl.run);
 		free(impl.run);
+		freeWorld(impl.world);
 		free(impl.world);
 		free(impl.config);
 		free(impl.dialog);
@@ -1812,6 +2271,14 @@ static void studioClose()
 		free(impl.surf);
 	}
 
+	if(impl.video.recorder)
+		recorder_close(impl.video.recorder);
+
+	rewind_delete(impl.rewind.frames);
+	free(impl.rewind.state);
+
+	fsFreeWatcher(impl.watcher);
+
 	if(impl.tic80local)
 		tic80_delete((tic80*)impl.tic80local);
 }
@@ -1864,7 +2331,12 @@ Studio* studioInit(s32 argc, char **argv, s32 samplerate, const char* folder, Sy
 	initKeymap();
 
 	initStart(impl.start, impl.studio.tic);
+	impl.watcher = fsCreateWatcher();
+
 	initConsole(impl.console, impl.studio.tic, impl.fs, impl.config, impl.argc, impl.argv);
+
+	if(impl.console->codeLiveReload.active)
+		fsWatch(impl.watcher, impl.console->codeLiveReload.fileName, WATCH_CODE);
 	initSurfMode();
 
 	initRunMode();
@@ -47,6 +47,13 @@
 #define TIC_COLOR_BG tic_color_0
 #define DEFAULT_CHMOD 0755
 
+#define PMEM_SYNC_INTERVAL 1000
+#define UNDO_BUDGET (1024 * 1024)
+#define IDLE_DELAY TIC80_FRAMERATE
+#define IDLE_RATE 6
+#define CONSOLE_LOG "stdout"
+#define CONSOLE_LOG_RATE 256
+
 #define CONFIG_TIC "config.tic"
 #define CONFIG_TIC_PATH TIC_LOCAL_VERSION CONFIG_TIC
 
@@ -102,6 +109,7 @@ void drawBitIcon(s32 x, s32 y, const u8* ptr, u8 color);
 
 void studioRomLoaded();
 void studioRomSaved();
+void studioRomReloaded(const tic_cartridge* cart);
 void studioConfigChanged();
 
 void setStudioMode(EditorMode mode);
@@ -135,6 +143,7 @@ typedef enum
 
 void setStudioEvent(StudioEvent event);
 void showTooltip(const char* text);
+void showPopupMessage(const char* text);
 
 tic_key* getKeymap();
 
@@ -147,7 +156,16 @@ void hideDialog();
 
 void hideGameMenu();
 
+// steps the paused game's RAM back up to `frames` frames, false when nothing was recorded,
+// the script VM isn't part of the snapshots so script variables keep their current values
+bool studioRewind(s32 frames);
+
+// sampling applies from the next run, 0 turns it off and keeps the last samples
+void setProfilePeriod(u32 period);
+const tic_profile* getProfile();
+
 bool studioCartChanged();
+void studioCartTouched();
 void playSystemSfx(s32 id);
 
 void runGameFromSurf();
@@ -168,6 +186,9 @@ bool anyKeyWasPressed();
 const StudioConfig* getConfig();
 System* getSystem();
 
+// like System httpGet, a finished request wakes the idle studio
+void studioHttpGet(const char* url, HttpGetCallback callback, void* calldata);
+
 #if defined(TIC80_PRO)
 
 bool hasProjectExt(const char* name);
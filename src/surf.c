@@ -162,6 +162,8 @@ typedef struct
 	MenuItem* items;
 	s32 count;
 	Surf* surf;
+	s32 generation;
+	char select[FILENAME_MAX];
 } AddMenuItem;
 
 static void resetMovie(Surf* surf, Movie* movie, void (*done)(Surf* surf))
@@ -430,62 +432,42 @@ static bool addMenuItem(const char* name, const char* info, s32 id, void* ptr, b
 	return true;
 }
 
-static void resetMenu(Surf* surf)
+static void freeMenuItems(MenuItem* items, s32 count)
 {
-	if(surf->menu.items)
+	for(s32 i = 0; i < count; i++)
 	{
-		for(s32 i = 0; i < surf->menu.count; i++)
-		{
-			free((void*)surf->menu.items[i].name);
-
-			const char* hash = surf->menu.items[i].hash;
-			if(hash) free((void*)hash);
+		free((void*)items[i].name);
 
-			tic_screen* cover = surf->menu.items[i].cover;
-			if(cover) free(cover);
+		const char* hash = items[i].hash;
+		if(hash) free((void*)hash);
 
-			const char* label = surf->menu.items[i].label;
-			if(label) free((void*)label);
-		}
-
-		free(surf->menu.items);
+		tic_screen* cover = items[i].cover;
+		if(cover) free(cover);
 
-		surf->menu.items = NULL;
-		surf->menu.count = 0;
+		const char* label = items[i].label;
+		if(label) free((void*)label);
 	}
 
-	surf->menu.pos = 0;
-	surf->menu.anim = 0;
+	free(items);
 }
 
-static void* requestCover(Surf* surf, const char* hash, s32* size)
+static void resetMenu(Surf* surf)
 {
-	char cachePath[FILENAME_MAX] = {0};
-	sprintf(cachePath, TIC_CACHE "%s.gif", hash);
-
+	if(surf->menu.items)
 	{
-		void* data = fsLoadRootFile(surf->fs, cachePath, size);
-
-		if(data)
-			return data;
-	}
-
-	char path[FILENAME_MAX] = {0};
-	sprintf(path, "/cart/%s/cover.gif", hash);
-	void* data = getSystem()->getUrlRequest(path, size);
+		freeMenuItems(surf->menu.items, surf->menu.count);
 
-	if(data)
-	{
-		fsSaveRootFile(surf->fs, cachePath, data, *size, false);
+		surf->menu.items = NULL;
+		surf->menu.count = 0;
 	}
 
-	return data;
+	surf->menu.pos = 0;
+	surf->menu.anim = 0;
+	surf->menu.generation++;
 }
 
-static void updateMenuItemCover(Surf* surf, const u8* cover, s32 size)
+static void updateMenuItemCover(MenuItem* item, const u8* cover, s32 size)
 {
-	MenuItem* item = &surf->menu.items[surf->menu.pos];
-
 	item->cover = calloc(1, sizeof(tic_screen));
 
 	gif_image* image = gif_read_data(cover, size);
@@ -509,6 +491,74 @@ static void updateMenuItemCover(Surf* surf, const u8* cover, s32 size)
 	}
 }
 
+typedef struct
+{
+	Surf* surf;
+	s32 generation;
+	s32 pos;
+	char cachePath[FILENAME_MAX];
+} CoverRequest;
+
+static void onCoverLoaded(const HttpGetData* data)
+{
+	CoverRequest* request = (CoverRequest*)data->calldata;
+	Surf* surf = request->surf;
+
+	if(data->status == HttpGetDone)
+	{
+		fsSaveRootFile(surf->fs, request->cachePath, data->data, data->size, false);
+
+		// menu could be reloaded while the cover was downloading
+		if(request->generation == surf->menu.generation && request->pos < surf->menu.count)
+		{
+			MenuItem* item = &surf->menu.items[request->pos];
+
+			if(!item->cover)
+				updateMenuItemCover(item, data->data, data->size);
+		}
+	}
+
+	free(request);
+}
+
+static void requestCover(Surf* surf, s32 pos)
+{
+	MenuItem* item = &surf->menu.items[pos];
+
+	char cachePath[FILENAME_MAX] = {0};
+	sprintf(cachePath, TIC_CACHE "%s.gif", item->hash);
+
+	{
+		s32 size = 0;
+		void* data = fsLoadRootFile(surf->fs, cachePath, &size);
+
+		if(data)
+		{
+			updateMenuItemCover(item, data, size);
+			free(data);
+			return;
+		}
+	}
+
+	CoverRequest* request = (CoverRequest*)malloc(sizeof(CoverRequest));
+
+	if(request)
+	{
+		*request = (CoverRequest)
+		{
+			.surf = surf,
+			.generation = surf->menu.generation,
+			.pos = pos,
+		};
+
+		strcpy(request->cachePath, cachePath);
+
+		char path[FILENAME_MAX] = {0};
+		sprintf(path, "/cart/%s/cover.gif", item->hash);
+		studioHttpGet(path, onCoverLoaded, request);
+	}
+}
+
 static void loadCover(Surf* surf)
 {
 	tic_mem* tic = surf->tic;
@@ -543,7 +593,7 @@ static void loadCover(Surf* surf)
 					tic->api.load(cart, data, size);
 
 				if(cart->cover.size)
-					updateMenuItemCover(surf, cart->cover.data, cart->cover.size);
+					updateMenuItemCover(item, cart->cover.data, cart->cover.size);
 
 				free(cart);
 			}
@@ -553,39 +603,80 @@ static void loadCover(Surf* surf)
 	}
 	else if(item->hash && !item->cover)
 	{
-		s32 size = 0;
+		requestCover(surf, surf->menu.pos);
+	}
+}
+
+static void selectMenuItem(Surf* surf, const char* path)
+{
+	char current[FILENAME_MAX];
+	fsGetDir(surf->fs, current);
 
-		u8* cover = requestCover(surf, item->hash, &size);
+	for(s32 i = 0; i < surf->menu.count; i++)
+	{
+		const MenuItem* item = &surf->menu.items[i];
 
-		if(cover)
+		if(item->dir)
 		{
-			updateMenuItemCover(surf, cover, size);
-			free(cover);
-		}       
+			char itemPath[FILENAME_MAX];
+
+			if(strlen(current))
+				sprintf(itemPath, "%s/%s", current, item->name);
+			else strcpy(itemPath, item->name);
+
+			if(strcmp(itemPath, path) == 0)
+			{
+				surf->menu.pos = i;
+				break;
+			}
+		}
 	}
 }
 
-static void initMenu(Surf* surf)
+static void onMenuLoaded(void* data)
 {
-	resetMenu(surf);
+	AddMenuItem* addMenuItemData = (AddMenuItem*)data;
+	Surf* surf = addMenuItemData->surf;
 
-	AddMenuItem data = 
+	// the folder could be left while the listing was loading
+	if(addMenuItemData->generation == surf->menu.generation)
 	{
-		.items = NULL,
-		.count = 0,
-		.surf = surf,
-	};
+		surf->menu.items = addMenuItemData->items;
+		surf->menu.count = addMenuItemData->count;
+		surf->menu.loading = false;
+
+		if(strlen(addMenuItemData->select))
+			selectMenuItem(surf, addMenuItemData->select);
+	}
+	else freeMenuItems(addMenuItemData->items, addMenuItemData->count);
+
+	free(addMenuItemData);
+}
+
+static void initMenu(Surf* surf, const char* select)
+{
+	resetMenu(surf);
+
+	AddMenuItem* data = (AddMenuItem*)calloc(1, sizeof(AddMenuItem));
+
+	if(!data) return;
+
+	data->surf = surf;
+	data->generation = surf->menu.generation;
+
+	if(select)
+		strcpy(data->select, select);
 
 	char dir[FILENAME_MAX];
 	fsGetDir(surf->fs, dir);
 
 	if(strcmp(dir, "") != 0)
-		addMenuItem("..", NULL, 0, &data, true);
+		addMenuItem("..", NULL, 0, data, true);
 
-	fsEnumFiles(surf->fs, addMenuItem, &data);
+	surf->menu.loading = true;
 
-	surf->menu.items = data.items;
-	surf->menu.count = data.count;
+	// public folders are filled in once the listing is downloaded
+	fsEnumFilesAsync(surf->fs, addMenuItem, onMenuLoaded, data);
 }
 
 static void onGoBackDir(Surf* surf)
@@ -594,38 +685,26 @@ static void onGoBackDir(Surf* surf)
 	fsGetDir(surf->fs, last);
 
 	fsDirBack(surf->fs);
-	initMenu(surf);
-
-	char current[FILENAME_MAX];
-	fsGetDir(surf->fs, current);
-
-	for(s32 i = 0; i < surf->menu.count; i++)
-	{
-		const MenuItem* item = &surf->menu.items[i];
-
-		if(item->dir)
-		{
-			char path[FILENAME_MAX];
+	initMenu(surf, last);
+}
 
-			if(strlen(current))
-				sprintf(path, "%s/%s", current, item->name);
-			else strcpy(path, item->name);
+static void onGoToDirDone(bool dir, void* data)
+{
+	Surf* surf = (Surf*)data;
 
-			if(strcmp(path, last) == 0)
-			{
-				surf->menu.pos = i;
-				break;
-			}
-		}
-	}
+	initMenu(surf, NULL);
 }
 
 static void onGoToDir(Surf* surf)
 {
-	MenuItem* item = &surf->menu.items[surf->menu.pos];
+	char dir[FILENAME_MAX];
+	strcpy(dir, surf->menu.items[surf->menu.pos].name);
+
+	// the menu stays empty until the folder is entered and listed
+	resetMenu(surf);
+	surf->menu.loading = true;
 
-	fsChangeDir(surf->fs, item->name);
-	initMenu(surf);
+	fsChangeDirAsync(surf->fs, dir, onGoToDirDone, surf);
 }
 
 static void changeDirectory(Surf* surf, const char* dir)
@@ -641,13 +720,22 @@ static void changeDirectory(Surf* surf, const char* dir)
 			resetMovie(surf, &MenuRightHideState, onGoBackDir);
 		}
 	}
-	else if(fsIsDir(surf->fs, dir))
+	else
 	{
 		playSystemSfx(2);
 		resetMovie(surf, &MenuLeftHideState, onGoToDir);
 	}
 }
 
+static void onCartLoaded(bool loaded, void* data)
+{
+	Surf* surf = (Surf*)data;
+
+	if(loaded)
+		runGameFromSurf();
+	else resetMovie(surf, &MenuModeShowState, NULL);
+}
+
 static void onPlayCart(Surf* surf)
 {
 	MenuItem* item = &surf->menu.items[surf->menu.pos];
@@ -671,7 +759,11 @@ static void onPlayCart(Surf* surf)
 		}
 	}
 	else
-		surf->console->load(surf->console, item->name, item->hash);
+	{
+		// downloaded carts run once they are loaded
+		surf->console->load(surf->console, item->name, item->hash, onCartLoaded, surf);
+		return;
+	}
 
 	runGameFromSurf();
 }
@@ -800,7 +892,7 @@ static void tick(Surf* surf)
 {
 	if(!surf->init)
 	{
-		initMenu(surf);
+		initMenu(surf, NULL);
 
 		resetMovie(surf, &MenuModeShowState, NULL);
 
@@ -837,9 +929,9 @@ static void tick(Surf* surf)
 	}
 	else
 	{
-		static const char Label[] = "You don't have any files...";
-		s32 size = tic->api.text(tic, Label, 0, -TIC_FONT_HEIGHT, tic_color_12, false);
-		tic->api.text(tic, Label, (TIC80_WIDTH - size) / 2, (TIC80_HEIGHT - TIC_FONT_HEIGHT)/2, tic_color_12, false);
+		const char* label = surf->menu.loading ? "Loading..." : "You don't have any files...";
+		s32 size = tic->api.text(tic, label, 0, -TIC_FONT_HEIGHT, tic_color_12, false);
+		tic->api.text(tic, label, (TIC80_WIDTH - size) / 2, (TIC80_HEIGHT - TIC_FONT_HEIGHT)/2, tic_color_12, false);
 	}
 }
 
@@ -42,6 +42,8 @@ struct Surf
 		s32 anim;
 		struct MenuItem* items;
 		s32 count;
+		s32 generation;
+		bool loading;
 	} menu;
 
 	void(*tick)(Surf* surf);
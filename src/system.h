@@ -2,6 +2,9 @@
 
 #include "ticapi.h"
 #include "ext/file_dialog.h"
+#include "net.h"
+
+#include <stdio.h>
 
 #define TIC80_OFFSET_LEFT ((TIC80_FULLWIDTH-TIC80_WIDTH)/2)
 #define TIC80_OFFSET_TOP ((TIC80_FULLHEIGHT-TIC80_HEIGHT)/2)
@@ -16,7 +19,7 @@ typedef struct
 	u64 	(*getPerformanceCounter)();
 	u64 	(*getPerformanceFrequency)();
 
-	void* (*getUrlRequest)(const char* url, s32* size);
+	void (*httpGet)(const char* url, HttpGetCallback callback, void* calldata);
 
 	void (*fileDialogLoad)(file_dialog_load_callback callback, void* data);
 	void (*fileDialogSave)(file_dialog_save_callback callback, const char* name, const u8* buffer, size_t size, void* data, u32 mode);
@@ -72,6 +75,13 @@ typedef struct
 
 	s32 gifScale;
 	s32 gifLength;
+	s32 pmemInterval;
+	s32 undoBudget;
+	s32 idleDelay;
+	s32 idleRate;
+	s32 consoleLogRate;
+
+	char consoleLog[FILENAME_MAX];
 	
 	bool checkNewVersion;
 	bool noSound;
@@ -90,6 +100,10 @@ typedef struct
 	tic_mem* tic;
 	bool quit;
 
+	// set when the last tick kept the previous frame, skipped counts such frames
+	bool idle;
+	u32 skipped;
+
 	void (*tick)();
 	void (*exit)();
 	void (*close)();
@@ -106,9 +106,14 @@ static u64 getPerformanceFrequency()
 	return HZ;
 }
 
-static void* getUrlRequest(const char* url, s32* size)
+static void httpGet(const char* url, HttpGetCallback callback, void* calldata)
 {
-	return NULL;
+	HttpGetData data = {};
+	data.status = HttpGetError;
+	data.url = url;
+	data.calldata = calldata;
+
+	callback(&data);
 }
 
 static void agoFullscreen()
@@ -160,7 +165,7 @@ static System systemInterface =
 	.getPerformanceCounter = getPerformanceCounter,
 	.getPerformanceFrequency = getPerformanceFrequency,
 
-	.getUrlRequest = getUrlRequest,
+	.httpGet = httpGet,
 
 	.fileDialogLoad = NULL, //file_dialog_load,
 	.fileDialogSave = NULL, //file_dialog_save,
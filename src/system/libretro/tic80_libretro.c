@@ -558,29 +558,6 @@ static void tic80_libretro_update(tic80* game)
 	tic80_tick(game, state.input);
 }
 
-/**
- * Convert between argb8888 and abgr8888.
- *
- * This was copied from libretro-common's scaler.c:
- * https://github.com/libretro/libretro-common/blob/master/gfx/scaler/scaler.c
- *
- * @see tic80_libretro_draw()
- */
-void tic80_libretro_conv_argb8888_abgr8888(uint32_t *output, uint32_t *input,
-	int width, int height,
-	int out_stride, int in_stride)
-{
-	int h, w;
-	for (h = 0; h < height; h++, output += out_stride >> 2, input += in_stride >> 2) {
-		for (w = 0; w < width; w++) {
-			uint32_t col = input[w];
-			output[w] = ((col << 16) & 0xff0000) | 
-				((col >> 16) & 0xff) |
-				(col & 0xff00ff00);
-		}
-	}
-}
-
 /**
  * Draw the screen.
  */
@@ -589,11 +566,6 @@ static void tic80_libretro_draw(tic80* game)
 	// Mouse Cursor
 	tic80_libretro_mousecursor((tic80_local*)game, &state.input.mouse, state.mouseCursor);
 
-	// TIC-80 uses ABGR8888, so we need to convert it.
-	tic80_libretro_conv_argb8888_abgr8888(frame_buf, game->screen,
-		TIC80_FULLWIDTH, TIC80_FULLHEIGHT,
-		TIC80_FULLWIDTH << 2, TIC80_FULLWIDTH << 2);
-
 	// Render to the screen.
 	video_cb(frame_buf, TIC80_FULLWIDTH, TIC80_FULLHEIGHT, TIC80_FULLWIDTH << 2);
 }
@@ -719,6 +691,9 @@ bool retro_load_game(const struct retro_game_info *info)
 	tic->callback.error = tic80_libretro_error;
 	tic->callback.trace = tic80_libretro_trace;
 
+	// The core blits straight into the frame buffer in the frontend's XRGB8888.
+	tic80_set_framebuffer(tic, frame_buf, TIC80_FULLWIDTH << 2, TIC80_PIXEL_ARGB8888, true);
+
 	// Initialize some of the game state.
 	state.quit = false;
 	state.input.mouse.x = 0;
@@ -768,15 +743,15 @@ bool retro_load_game_special(unsigned type, const struct retro_game_info *info,
 }
 
 /**
- * libretro callback; Retrieve the size of the serialized memory.
+ * libretro callback; Retrieve the size of a machine snapshot.
  */
 size_t retro_serialize_size(void)
 {
-	return TIC_PERSISTENT_SIZE * sizeof(u32);
+	return tic ? tic80_state_size(tic) : 0;
 }
 
 /**
- * libretro callback; Get the current persistent memory.
+ * libretro callback; Save a machine snapshot.
  */
 bool retro_serialize(void *data, size_t size)
 {
@@ -784,30 +759,30 @@ bool retro_serialize(void *data, size_t size)
 		return false;
 	}
 
-	tic80_local* tic80 = (tic80_local*)tic;
-	u32* udata = (u32*)data;
-	for (int i = 0; i < TIC_PERSISTENT_SIZE; i++) {
-		udata[i] = tic80->memory->ram.persistent.data[i];
+	if (!tic80_save_state(tic, data, (u32)size)) {
+		return false;
 	}
+
+	tic80_local* tic80 = (tic80_local*)tic;
 	tic80->tickData.syncPMEM = true;
 
 	return true;
 }
 
 /**
- * libretro callback; Given the serialized data, load it into the persistent memory.
+ * libretro callback; Restore a machine snapshot.
  */
 bool retro_unserialize(const void *data, size_t size)
 {
-	if (!tic || size != retro_serialize_size() || !data) {
+	if (!tic || !data) {
 		return false;
 	}
 
-	tic80_local* tic80 = (tic80_local*)tic;
-	u32* uData = (u32*)data;
-	for (int i = 0; i < TIC_PERSISTENT_SIZE; i++) {
-		tic80->memory->ram.persistent.data[i] = uData[i];
+	if (!tic80_load_state(tic, data, (u32)size)) {
+		return false;
 	}
+
+	tic80_local* tic80 = (tic80_local*)tic;
 	tic80->tickData.syncPMEM = true;
 
 	return true;
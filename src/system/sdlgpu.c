@@ -23,6 +23,7 @@
 #include "system.h"
 #include "net.h"
 #include "tools.h"
+#include "tracing.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -1298,9 +1299,9 @@ static void openSystemPath(const char* path) {}
 
 #endif
 
-static void* getUrlRequest(const char* url, s32* size)
+static void httpGet(const char* url, HttpGetCallback callback, void* calldata)
 {
-	return netGetRequest(platform.net, url, size);
+	netGet(platform.net, url, callback, calldata);
 }
 
 static void preseed()
@@ -1422,7 +1423,7 @@ static System systemInterface =
 	.getPerformanceCounter = getPerformanceCounter,
 	.getPerformanceFrequency = getPerformanceFrequency,
 
-	.getUrlRequest = getUrlRequest,
+	.httpGet = httpGet,
 
 	.fileDialogLoad = file_dialog_load,
 	.fileDialogSave = file_dialog_save,
@@ -1454,12 +1455,15 @@ static void gpuTick()
 	if(platform.inBackground)
 		return;
 
+	netTick(platform.net);
+
 	GPU_Clear(platform.gpu.screen);
 
 	{
 		platform.studio->tick();
 
-		GPU_UpdateImageBytes(platform.gpu.texture, NULL, (const u8*)tic->screen, TIC80_FULLWIDTH * sizeof(u32));
+		if(!platform.studio->idle)
+			GPU_UpdateImageBytes(platform.gpu.texture, NULL, (const u8*)tic->screen, TIC80_FULLWIDTH * sizeof(u32));
 
 		{
 			if(platform.studio->config()->crtMonitor)
@@ -1505,7 +1509,9 @@ static void gpuTick()
 #endif
 	}
 
+	TRACE_BEGIN("present");
 	GPU_Flip(platform.gpu.screen);
+	TRACE_END("present");
 
 	blitSound();
 }
@@ -1551,7 +1557,7 @@ static s32 start(s32 argc, char **argv, const char* folder)
 
 	initSound();
 
-	platform.net = createNet();
+	platform.net = createNet(getenv("TIC80_HOST"));
 
 	platform.studio = studioInit(argc, argv, platform.audio.spec.freq, folder, &systemInterface);
 
@@ -1592,7 +1598,12 @@ static s32 start(s32 argc, char **argv, const char* folder)
 					nextTick -= delay;
 					platform.missedFrame = true;
 				}
-				else SDL_Delay((u32)(delay * 1000 / SDL_GetPerformanceFrequency()));
+				else
+				{
+					TRACE_BEGIN("sleep");
+					SDL_Delay((u32)(delay * 1000 / SDL_GetPerformanceFrequency()));
+					TRACE_END("sleep");
+				}
 			}
 		}
 	}
@@ -86,9 +86,9 @@ static u64 getPerformanceFrequency()
 	return 1000;
 }
 
-static void* getUrlRequest(const char* url, s32* size)
+static void httpGet(const char* url, HttpGetCallback callback, void* calldata)
 {
-	return netGetRequest(platform.net, url, size);
+	netGet(platform.net, url, callback, calldata);
 }
 
 static void goFullscreen()
@@ -139,7 +139,7 @@ static System systemInterface =
 	.getPerformanceCounter = getPerformanceCounter,
 	.getPerformanceFrequency = getPerformanceFrequency,
 
-	.getUrlRequest = getUrlRequest,
+	.httpGet = httpGet,
 
 	.fileDialogLoad = file_dialog_load,
 	.fileDialogSave = file_dialog_save,
@@ -185,6 +185,7 @@ static void app_frame(void)
 
 	input->gamepads.data = 0;
 	handleKeyboard();
+	netTick(platform.net);
 	platform.studio->tick();
 
 	sokol_gfx_draw(platform.studio->tic->screen);
@@ -405,7 +406,7 @@ sapp_desc sokol_main(s32 argc, char* argv[])
 	platform.audio.desc.num_channels = TIC_STEREO_CHANNELS;
 	saudio_setup(&platform.audio.desc);
 
-    platform.net = createNet();
+    platform.net = createNet(getenv("TIC80_HOST"));
 
 	platform.studio = studioInit(argc, argv, saudio_sample_rate(), "./", &systemInterface);
 
@@ -31,6 +31,7 @@
 #include "tools.h"
 #include "machine.h"
 #include "ext/gif.h"
+#include "tracing.h"
 
 #define CLOCKRATE (255<<13)
 #define ENVELOPE_FREQ_SCALE 2
@@ -175,26 +176,57 @@ static void setPixelDma(tic_mem* tic, s32 x, s32 y, u8 color)
 	tic_tool_poke4(tic->ram.vram.screen.data, y * TIC80_WIDTH + x, color);
 }
 
-static inline u32* getOvrAddr(tic_mem* tic, s32 x, s32 y)
+static inline u8* getOvrRow(tic_mem* tic, s32* x, s32 y)
 {
 	enum {Top = (TIC80_FULLHEIGHT-TIC80_HEIGHT)/2};
 	enum {Left = (TIC80_FULLWIDTH-TIC80_WIDTH)/2};
 
-	return tic->screen + x + (y << TIC80_FULLWIDTH_BITS) + (Left + Top * TIC80_FULLWIDTH);
+	if(tic->framebuffer.border)
+	{
+		*x += Left;
+		y += Top;
+	}
+
+	return (u8*)tic->framebuffer.pixels + y * tic->framebuffer.pitch;
+}
+
+// OVR colors are kept in the framebuffer format
+static void putOvrPixel(tic_mem* tic, s32 x, s32 y, u32 color)
+{
+	u8* row = getOvrRow(tic, &x, y);
+
+	switch(tic->framebuffer.format)
+	{
+	case TIC80_PIXEL_RGB565: ((u16*)row)[x] = color; break;
+	case TIC80_PIXEL_INDEXED4: tic_tool_poke4(row, x, color); break;
+	default: ((u32*)row)[x] = color; break;
+	}
+}
+
+static u32 getOvrPixel(tic_mem* tic, s32 x, s32 y)
+{
+	u8* row = getOvrRow(tic, &x, y);
+
+	switch(tic->framebuffer.format)
+	{
+	case TIC80_PIXEL_RGB565: return ((u16*)row)[x];
+	case TIC80_PIXEL_INDEXED4: return tic_tool_peek4(row, x);
+	default: return ((u32*)row)[x];
+	}
 }
 
 static void setPixelOvr(tic_mem* tic, s32 x, s32 y, u8 color)
 {
 	tic_machine* machine = (tic_machine*)tic;
 	
-	*getOvrAddr(tic, x, y) = *(machine->state.ovr.palette + color);
+	putOvrPixel(tic, x, y, machine->state.ovr.palette[color]);
 }
 
 static u8 getPixelOvr(tic_mem* tic, s32 x, s32 y)
 {
 	tic_machine* machine = (tic_machine*)tic;
 	
-	u32 color = *getOvrAddr(tic, x, y);
+	u32 color = getOvrPixel(tic, x, y);
 	u32* pal = machine->state.ovr.palette;
 
 	for(s32 i = 0; i < TIC_PALETTE_SIZE; i++, pal++)
@@ -246,7 +278,7 @@ static void drawHLineOvr(tic_mem* tic, s32 x1, s32 x2, s32 y, u8 color)
 	tic_machine* machine = (tic_machine*)tic;
 	u32 final_color = *(machine->state.ovr.palette + color);
 	for(s32 x = x1; x < x2; ++x) {
-		*getOvrAddr(tic, x, y) = final_color;
+		putOvrPixel(tic, x, y, final_color);
 	}
 }
 
@@ -644,16 +676,91 @@ static void api_clear(tic_mem* memory, u8 color)
 	}
 }
 
+static const tic_glyph* getGlyph(tic_machine* machine, u8 symbol, bool alt)
+{
+	s32 index = (symbol + (alt ? TIC_FONT_CHARS / 2 : 0)) % TIC_FONT_CHARS;
+	const u8* rows = machine->memory.font.data + index * BITS_IN_BYTE;
+	tic_glyph* glyph = alt ? &machine->glyphs.altfont[index] : &machine->glyphs.font[index];
+
+	if(glyph->ready && memcmp(glyph->source, rows, TIC_FONT_HEIGHT) == 0)
+		return glyph;
+
+	const s32 FontWidth = alt ? TIC_ALTFONT_WIDTH : TIC_FONT_WIDTH;
+
+	memcpy(glyph->source, rows, TIC_FONT_HEIGHT);
+	glyph->start = FontWidth;
+	glyph->end = 0;
+
+	for(s32 row = 0; row < TIC_FONT_HEIGHT; row++)
+	{
+		glyph->count[row] = 0;
+
+		for(s32 col = 0; col < FontWidth; col++)
+		{
+			if(!(rows[row] & 0b10000000 >> col)) continue;
+
+			if(col < glyph->start) glyph->start = col;
+			if(col >= glyph->end) glyph->end = col + 1;
+
+			if(col && rows[row] & 0b10000000 >> (col - 1))
+				glyph->spans[row][glyph->count[row] - 1].w++;
+			else
+			{
+				glyph->spans[row][glyph->count[row]].x = col;
+				glyph->spans[row][glyph->count[row]].w = 1;
+				glyph->count[row]++;
+			}
+		}
+	}
+
+	if(glyph->end == 0)
+		glyph->start = 0;
+
+	glyph->ready = true;
+
+	return glyph;
+}
+
+static void drawGlyph(tic_machine* machine, const tic_glyph* glyph, s32 x, s32 y, u8 color, s32 scale)
+{
+	const tic_clip_data* clip = &machine->state.clip;
+
+	// spans of a glyph that is completely visible go straight to the line writer
+	if(x + glyph->start * scale >= clip->l && x + glyph->end * scale <= clip->r 
+		&& y >= clip->t && y + TIC_FONT_HEIGHT * scale <= clip->b)
+	{
+		color = mapColor(&machine->memory, color);
+
+		for(s32 row = 0; row < TIC_FONT_HEIGHT; row++, y += scale)
+			for(s32 i = 0; i < glyph->count[row]; i++)
+			{
+				s32 xl = x + glyph->spans[row][i].x * scale;
+				s32 xr = xl + glyph->spans[row][i].w * scale;
+
+				for(s32 ys = y; ys < y + scale; ys++)
+					machine->state.drawhline(&machine->memory, xl, xr, ys, color);
+			}
+	}
+	else
+	{
+		for(s32 row = 0; row < TIC_FONT_HEIGHT; row++, y += scale)
+			for(s32 i = 0; i < glyph->count[row]; i++)
+				drawRect(machine, x + glyph->spans[row][i].x * scale, y, glyph->spans[row][i].w * scale, scale, color);
+	}
+}
+
 static s32 drawChar(tic_mem* memory, u8 symbol, s32 x, s32 y, s32 width, s32 height, u8 color, s32 scale, bool alt)
 {
-	const u8* ptr = memory->font.data + (symbol + (alt ? TIC_FONT_CHARS / 2 : 0))*BITS_IN_BYTE;
-	x += (BITS_IN_BYTE - 1)*scale;
+	const s32 FontWidth = alt ? TIC_ALTFONT_WIDTH : TIC_FONT_WIDTH;
 
-	for(s32 i = 0, ys = y; i < TIC_FONT_HEIGHT; i++, ptr++, ys += scale)
-		for(s32 col = BITS_IN_BYTE - (alt ? TIC_ALTFONT_WIDTH : TIC_FONT_WIDTH), xs = x - col; col < BITS_IN_BYTE; col++, xs -= scale)
-			if(*ptr & 1 << col)
-				api_rect(memory, xs, ys, scale, scale, color);
+	drawGlyph((tic_machine*)memory, getGlyph((tic_machine*)memory, symbol, alt), 
+		x + (BITS_IN_BYTE - FontWidth)*(scale - 1), y, color, scale);
+
+	return FontWidth*scale;
+}
 
+static s32 measureChar(tic_mem* memory, u8 symbol, s32 x, s32 y, s32 width, s32 height, u8 color, s32 scale, bool alt)
+{
 	return (alt ? TIC_ALTFONT_WIDTH : TIC_FONT_WIDTH)*scale;
 }
 
@@ -689,41 +796,24 @@ static s32 api_fixed_text(tic_mem* memory, const char* text, s32 x, s32 y, u8 co
 	return drawText(memory, text, x, y, alt ? TIC_ALTFONT_WIDTH : TIC_FONT_WIDTH, TIC_FONT_HEIGHT, color, 1, drawChar, alt);
 }
 
-static s32 drawNonFixedChar(tic_mem* memory, u8 symbol, s32 x, s32 y, s32 width, s32 height, u8 color, s32 scale, bool alt)
+static s32 getNonFixedCharWidth(const tic_glyph* glyph, s32 scale, bool alt)
 {
-	const u8* ptr = memory->font.data + (symbol + (alt ? TIC_FONT_CHARS / 2 : 0))*BITS_IN_BYTE;
-
-	const s32 FontWidth = alt ? TIC_ALTFONT_WIDTH : TIC_FONT_WIDTH;
-
-	s32 start = 0;
-	s32 end = FontWidth;
-	s32 i = 0;
-
-	for(s32 col = 0; col < FontWidth; col++)
-	{
-		for(i = 0; i < TIC_FONT_HEIGHT; i++)
-			if(*(ptr + i) & 0b10000000 >> col) break;
-
-		if(i < TIC_FONT_HEIGHT)	break; else start++;
-	}
+	s32 size = glyph->end - glyph->start;
+	return (size ? size + 1 : (alt ? TIC_ALTFONT_WIDTH : TIC_FONT_WIDTH) - 2) * scale;
+}
 
-	x -= start * scale;
-	
-	for(s32 col = FontWidth - 1; col >= start; col--)
-	{
-		for(i = 0; i < TIC_FONT_HEIGHT; i++)
-			if(*(ptr + i) & 0b10000000 >> col) break;
+static s32 drawNonFixedChar(tic_mem* memory, u8 symbol, s32 x, s32 y, s32 width, s32 height, u8 color, s32 scale, bool alt)
+{
+	const tic_glyph* glyph = getGlyph((tic_machine*)memory, symbol, alt);
 
-		if(i < TIC_FONT_HEIGHT)	break; else end--;
-	}
+	drawGlyph((tic_machine*)memory, glyph, x - glyph->start * scale, y, color, scale);
 
-	for(s32 ys = y, i = 0; i < TIC_FONT_HEIGHT; i++, ptr++, ys += scale)
-		for(s32 col = start, xs = x + start*scale; col < end; col++, xs += scale)
-			if(*ptr & 0b10000000 >> col)
-				api_rect(memory, xs, ys, scale, scale, color);
+	return getNonFixedCharWidth(glyph, scale, alt);
+}
 
-	s32 size = end - start;
-	return (size ? size + 1 : FontWidth - 2) * scale;
+static s32 measureNonFixedChar(tic_mem* memory, u8 symbol, s32 x, s32 y, s32 width, s32 height, u8 color, s32 scale, bool alt)
+{
+	return getNonFixedCharWidth(getGlyph((tic_machine*)memory, symbol, alt), scale, alt);
 }
 
 static s32 api_text(tic_mem* memory, const char* text, s32 x, s32 y, u8 color, bool alt)
@@ -736,6 +826,11 @@ static s32 api_text_ex(tic_mem* memory, const char* text, s32 x, s32 y, u8 color
 	return drawText(memory, text, x, y, alt ? TIC_ALTFONT_WIDTH : TIC_FONT_WIDTH, TIC_FONT_HEIGHT, color, scale, fixed ? drawChar : drawNonFixedChar, alt);
 }
 
+static s32 api_text_width(tic_mem* memory, const char* text, bool fixed, s32 scale, bool alt)
+{
+	return drawText(memory, text, 0, 0, alt ? TIC_ALTFONT_WIDTH : TIC_FONT_WIDTH, TIC_FONT_HEIGHT, 0, scale, fixed ? measureChar : measureNonFixedChar, alt);
+}
+
 static void drawSprite(tic_mem* memory, const tic_tiles* src, s32 index, s32 x, s32 y, u8* colors, s32 count, s32 scale, tic_flip flip, tic_rotate rotate)
 {
 	if(index < TIC_SPRITES)
@@ -813,46 +908,65 @@ s32 drawSpriteFont(tic_mem* memory, u8 symbol, s32 x, s32 y, s32 width, s32 heig
 	return width * scale;
 }
 
-s32 drawFixedSpriteFont(tic_mem* memory, u8 index, s32 x, s32 y, s32 width, s32 height, u8 chromakey, s32 scale, bool alt)
+static const tic_sprite_glyph* getSpriteGlyph(tic_machine* machine, u8 index, u8 chromakey)
 {
-	const u8* ptr = memory->ram.sprites.data[index].data;
+	const tic_tile* tile = &machine->memory.ram.sprites.data[index];
+	tic_sprite_glyph* glyph = &machine->glyphs.sprites[index];
+
+	if(glyph->ready && glyph->chromakey == chromakey && memcmp(&glyph->source, tile, sizeof(tic_tile)) == 0)
+		return glyph;
 
 	enum {Size = TIC_SPRITESIZE};
 
-	s32 start = 0;
-	s32 end = Size;
-	s32 i = 0;
+	glyph->source = *tile;
+	glyph->chromakey = chromakey;
+	glyph->start = Size;
+	glyph->end = 0;
 
 	for(s32 col = 0; col < Size; col++)
-	{
-		for(i = 0; i < Size*Size; i += Size)
-			if(tic_tool_peek4(ptr, col + i) != chromakey) break;
+		for(s32 row = 0; row < Size; row++)
+			if(tic_tool_peek4(tile->data, col + row * Size) != chromakey)
+			{
+				if(col < glyph->start) glyph->start = col;
+				glyph->end = col + 1;
+				break;
+			}
 
-		if(i < Size*Size) break; else start++;
-	}
+	if(glyph->end == 0)
+		glyph->start = 0;
 
-	x -= start * scale;
-	
-	for(s32 col = Size - 1; col >= start; col--)
-	{
-		for(i = 0; i < Size*Size; i += Size)
-			if(tic_tool_peek4(ptr, col + i) != chromakey) break;
+	glyph->ready = true;
 
-		if(i < Size*Size) break; else end--;
-	}
+	return glyph;
+}
+
+s32 drawFixedSpriteFont(tic_mem* memory, u8 index, s32 x, s32 y, s32 width, s32 height, u8 chromakey, s32 scale, bool alt)
+{
+	tic_machine* machine = (tic_machine*)memory;
+	const u8* ptr = memory->ram.sprites.data[index].data;
+	const tic_sprite_glyph* glyph = getSpriteGlyph(machine, index, chromakey);
+
+	enum {Size = TIC_SPRITESIZE};
+
+	x -= glyph->start * scale;
 
 	for(s32 row = 0, ys = y; row < Size; row++, ys += scale)
 	{
-		for(s32 col = start, xs = x + start*scale; col < end; col++, xs += scale)
+		for(s32 col = glyph->start; col < glyph->end;)
 		{
 			u8 color = tic_tool_peek4(ptr, col + row * Size);
+			s32 next = col + 1;
+
+			while(next < glyph->end && tic_tool_peek4(ptr, next + row * Size) == color) next++;
 
 			if(color != chromakey)
-				api_rect(memory, xs, ys, scale, scale, color);
+				drawRect(machine, x + col*scale, ys, (next - col)*scale, scale, color);
+
+			col = next;
 		}
 	}
 
-	s32 size = end - start;
+	s32 size = glyph->end - glyph->start;
 	return (size ? size + 1 : width) * scale;
 }
 
@@ -1491,6 +1605,8 @@ static void api_tick_start(tic_mem* memory, const tic_sfx* sfxsrc, const tic_mus
 {
 	tic_machine* machine = (tic_machine*)memory;
 
+	TRACE_BEGIN("tick_start");
+
 	machine->sound.sfx = sfxsrc;
 	machine->sound.music = music;
 
@@ -1537,6 +1653,8 @@ static void api_tick_start(tic_mem* memory, const tic_sfx* sfxsrc, const tic_mus
 	machine->state.getpix = getPixelDma;
 	machine->state.synced = 0;
 	machine->state.drawhline = drawHLineDma;
+
+	TRACE_END("tick_start");
 }
 
 static void stereo_tick_end(tic_mem* memory, tic_sound_register_data* registers, blip_buffer_t* blip, u8 stereoRight)
@@ -1566,11 +1684,20 @@ static void api_tick_end(tic_mem* memory)
 	machine->state.gamepads.previous.data = machine->memory.ram.input.gamepads.data;
 	machine->state.keyboard.previous.data = machine->memory.ram.input.keyboard.data;
 
-	stereo_tick_end(memory, machine->state.registers.left, machine->blip.left, 0);
-	stereo_tick_end(memory, machine->state.registers.right, machine->blip.right, 1);
+	TRACE_BEGIN("audio");
+
+	if(machine->sound.skip)
+		memset(machine->memory.samples.buffer, 0, machine->memory.samples.size);
+	else
+	{
+		stereo_tick_end(memory, machine->state.registers.left, machine->blip.left, 0);
+		stereo_tick_end(memory, machine->state.registers.right, machine->blip.right, 1);
+
+		blip_read_samples(machine->blip.left, machine->memory.samples.buffer, machine->samplerate / TIC80_FRAMERATE, TIC_STEREO_CHANNELS);
+		blip_read_samples(machine->blip.right, machine->memory.samples.buffer + 1, machine->samplerate / TIC80_FRAMERATE, TIC_STEREO_CHANNELS);
+	}
 
-	blip_read_samples(machine->blip.left, machine->memory.samples.buffer, machine->samplerate / TIC80_FRAMERATE, TIC_STEREO_CHANNELS);
-	blip_read_samples(machine->blip.right, machine->memory.samples.buffer + 1, machine->samplerate / TIC80_FRAMERATE, TIC_STEREO_CHANNELS);
+	TRACE_END("audio");
 
 	machine->state.setpix = setPixelOvr;
 	machine->state.getpix = getPixelOvr;
@@ -1673,6 +1800,9 @@ static void api_sync(tic_mem* tic, u32 mask, s32 bank, bool toCart)
 	}
 
 	machine->state.synced |= mask;
+
+	if(toCart && mask)
+		machine->resident |= 1 << bank;
 }
 
 static void cart2ram(tic_mem* memory)
@@ -1858,7 +1988,9 @@ static void api_tick(tic_mem* tic, tic_tick_data* data)
 		}
 	}
 
+	TRACE_BEGIN("TIC");
 	machine->state.tick(tic);
+	TRACE_END("TIC");
 }
 
 static void api_scanline(tic_mem* memory, s32 row, void* data)
@@ -1866,7 +1998,11 @@ static void api_scanline(tic_mem* memory, s32 row, void* data)
 	tic_machine* machine = (tic_machine*)memory;
 
 	if(machine->state.initialized)
+	{
+		TRACE_BEGIN("SCN");
 		machine->state.scanline(memory, row, data);
+		TRACE_END("SCN");
+	}
 }
 
 static void api_overline(tic_mem* memory, void* data)
@@ -1874,7 +2010,11 @@ static void api_overline(tic_mem* memory, void* data)
 	tic_machine* machine = (tic_machine*)memory;
 
 	if(machine->state.initialized)
+	{
+		TRACE_BEGIN("OVR");
 		machine->state.ovr.callback(memory, data);
+		TRACE_END("OVR");
+	}
 }
 
 static double api_time(tic_mem* memory)
@@ -1954,12 +2094,28 @@ static bool api_keyp(tic_mem* tic, tic_key key, s32 hold, s32 period)
 	return false;
 }
 
-static void api_load(tic_cartridge* cart, const u8* buffer, s32 size)
+// returns the mask of banks it wrote to
+static u8 api_load(tic_cartridge* cart, const u8* buffer, s32 size)
 {
 	const u8* end = buffer + size;
-	memset(cart, 0, sizeof(tic_cartridge));
+	u8 written = 0;
+
+	// banks are only cleared when they hold data, so the ones no chunk
+	// targets are never written and stay unmaterialized
+	for(s32 i = 0; i < TIC_BANKS; i++)
+		if(!tic_tool_empty(&cart->banks[i], sizeof(tic_bank)))
+		{
+			memset(&cart->banks[i], 0, sizeof(tic_bank));
+			written |= 1 << i;
+		}
+
+	memset(&cart->code, 0, sizeof(tic_code));
+
+	if(!tic_tool_empty(&cart->cover, sizeof(tic_cover_image)))
+		memset(&cart->cover, 0, sizeof(tic_cover_image));
 
 	#define LOAD_CHUNK(to) memcpy(&to, buffer, MIN(sizeof(to), chunk.size))
+	#define LOAD_BANK_CHUNK(to) (written |= 1 << chunk.bank, LOAD_CHUNK(cart->banks[chunk.bank].to))
 
 	bool paletteExists = false;
 
@@ -1971,15 +2127,15 @@ static void api_load(tic_cartridge* cart, const u8* buffer, s32 size)
 
 		switch(chunk.type)
 		{
-		case CHUNK_TILES: 		LOAD_CHUNK(cart->banks[chunk.bank].tiles); 			break;
-		case CHUNK_SPRITES: 	LOAD_CHUNK(cart->banks[chunk.bank].sprites); 		break;
-		case CHUNK_MAP: 		LOAD_CHUNK(cart->banks[chunk.bank].map); 			break;
-		case CHUNK_SAMPLES: 	LOAD_CHUNK(cart->banks[chunk.bank].sfx.samples); 	break;
-		case CHUNK_WAVEFORM:	LOAD_CHUNK(cart->banks[chunk.bank].sfx.waveforms); 	break;
-		case CHUNK_MUSIC:		LOAD_CHUNK(cart->banks[chunk.bank].music.tracks); 	break;
-		case CHUNK_PATTERNS:	LOAD_CHUNK(cart->banks[chunk.bank].music.patterns);	break;
-		case CHUNK_PALETTE:		LOAD_CHUNK(cart->banks[chunk.bank].palette);		break;
-		case CHUNK_FLAGS:		LOAD_CHUNK(cart->banks[chunk.bank].flags);			break;
+		case CHUNK_TILES:		LOAD_BANK_CHUNK(tiles);				break;
+		case CHUNK_SPRITES:		LOAD_BANK_CHUNK(sprites);			break;
+		case CHUNK_MAP:			LOAD_BANK_CHUNK(map);				break;
+		case CHUNK_SAMPLES:		LOAD_BANK_CHUNK(sfx.samples);		break;
+		case CHUNK_WAVEFORM:	LOAD_BANK_CHUNK(sfx.waveforms);		break;
+		case CHUNK_MUSIC:		LOAD_BANK_CHUNK(music.tracks);		break;
+		case CHUNK_PATTERNS:	LOAD_BANK_CHUNK(music.patterns);	break;
+		case CHUNK_PALETTE:		LOAD_BANK_CHUNK(palette);			break;
+		case CHUNK_FLAGS:		LOAD_BANK_CHUNK(flags);				break;
 		case CHUNK_CODE: 		
 			if(chunk.bank == 0)
 				LOAD_CHUNK(cart->code);
@@ -1993,7 +2149,7 @@ static void api_load(tic_cartridge* cart, const u8* buffer, s32 size)
 				// workaround to load deprecated music patterns section
 				// and automatically convert volume value to a command
 				tic_patterns* ptrns = &cart->banks[chunk.bank].music.patterns;
-				LOAD_CHUNK(*ptrns);
+				LOAD_BANK_CHUNK(music.patterns);
 				for(s32 i = 0; i < MUSIC_PATTERNS; i++)
 					for(s32 r = 0; r < MUSIC_PATTERN_ROWS; r++)
 					{
@@ -2016,6 +2172,7 @@ static void api_load(tic_cartridge* cart, const u8* buffer, s32 size)
 	}
 
 	#undef LOAD_CHUNK
+	#undef LOAD_BANK_CHUNK
 
 	// workaround to support ancient carts without palette
 	// load DB16 palette if it not exists
@@ -2023,7 +2180,10 @@ static void api_load(tic_cartridge* cart, const u8* buffer, s32 size)
 	{
 		static const u8 DB16[] = {0x14, 0x0c, 0x1c, 0x44, 0x24, 0x34, 0x30, 0x34, 0x6d, 0x4e, 0x4a, 0x4e, 0x85, 0x4c, 0x30, 0x34, 0x65, 0x24, 0xd0, 0x46, 0x48, 0x75, 0x71, 0x61, 0x59, 0x7d, 0xce, 0xd2, 0x7d, 0x2c, 0x85, 0x95, 0xa1, 0x6d, 0xaa, 0x2c, 0xd2, 0xaa, 0x99, 0x6d, 0xc2, 0xca, 0xda, 0xd4, 0x5e, 0xde, 0xee, 0xd6};
 		memcpy(cart->bank0.palette.data, DB16, sizeof(tic_palette));
+		written |= 1;
 	}
+
+	return written;
 }
 
 
@@ -2120,9 +2280,93 @@ static inline void memset4(void *dst, u32 val, u32 dwords)
 #endif
 }
 
+static void framebufferPalette(tic_mem* tic, u32* pal)
+{
+	const u32* src = tic_palette_blit(&tic->ram.vram.palette);
+
+	for(s32 i = 0; i < TIC_PALETTE_SIZE; i++)
+	{
+		u32 c = src[i];
+
+		switch(tic->framebuffer.format)
+		{
+		case TIC80_PIXEL_ARGB8888: pal[i] = (c & 0xff00ff00) | (c << 16 & 0xff0000) | (c >> 16 & 0xff); break;
+		case TIC80_PIXEL_RGB565: pal[i] = (c << 8 & 0xf800) | (c >> 5 & 0x7e0) | (c >> 19 & 0x1f); break;
+		case TIC80_PIXEL_INDEXED4: pal[i] = i; break;
+		default: pal[i] = c; break;
+		}
+	}
+}
+
+static inline s32 framebufferBytes(const tic_mem* tic, s32 pixels)
+{
+	switch(tic->framebuffer.format)
+	{
+	case TIC80_PIXEL_RGB565: return pixels * sizeof(u16);
+	case TIC80_PIXEL_INDEXED4: return pixels / 2;
+	default: return pixels * sizeof(u32);
+	}
+}
+
+static void blitFill(tic_mem* tic, u8* dst, s32 pixels, u32 color)
+{
+	switch(tic->framebuffer.format)
+	{
+	case TIC80_PIXEL_RGB565:
+		for(s32 i = 0; i < pixels; i++)
+			((u16*)dst)[i] = color;
+		break;
+	case TIC80_PIXEL_INDEXED4: memset(dst, color << 4 | color, pixels / 2); break;
+	default: memset4(dst, color, pixels); break;
+	}
+}
+
+static void blitLine(tic_mem* tic, u8* dst, s32 r, const u32* pal)
+{
+	const u8* src = tic->ram.vram.screen.data + ((r + tic->ram.vram.vars.offset.y + TIC80_HEIGHT) % TIC80_HEIGHT * TIC80_WIDTH >> 1);
+	u32 x = (-tic->ram.vram.vars.offset.x + TIC80_WIDTH) % TIC80_WIDTH;
+
+	switch(tic->framebuffer.format)
+	{
+	case TIC80_PIXEL_RGB565:
+		{
+			u16* out = (u16*)dst;
+
+			for(s32 c = 0; c < TIC80_WIDTH / 2; c++)
+			{
+				u8 val = src[c];
+				out[x++ % TIC80_WIDTH] = pal[val & 0xf];
+				out[x++ % TIC80_WIDTH] = pal[val >> 4];
+			}
+		}
+		break;
+	case TIC80_PIXEL_INDEXED4:
+		if(x == 0) memcpy(dst, src, TIC80_WIDTH / 2);
+		else
+			for(s32 c = 0; c < TIC80_WIDTH; c++)
+				tic_tool_poke4(dst, x++ % TIC80_WIDTH, tic_tool_peek4(src, c));
+		break;
+	default:
+		{
+			u32* out = (u32*)dst;
+
+			for(s32 c = 0; c < TIC80_WIDTH / 2; c++)
+			{
+				u8 val = src[c];
+				out[x++ % TIC80_WIDTH] = pal[val & 0xf];
+				out[x++ % TIC80_WIDTH] = pal[val >> 4];
+			}
+		}
+		break;
+	}
+}
+
 static void api_blit(tic_mem* tic, tic_scanline scanline, tic_overline overline, void* data)
 {
-	const u32* pal = tic_palette_blit(&tic->ram.vram.palette);
+	TRACE_BEGIN("blit");
+
+	u32 pal[TIC_PALETTE_SIZE];
+	framebufferPalette(tic, pal);
 
 	{
 		tic_machine* machine = (tic_machine*)tic;
@@ -2132,42 +2376,58 @@ static void api_blit(tic_mem* tic, tic_scanline scanline, tic_overline overline,
 	if(scanline)
 	{
 		scanline(tic, 0, data);
-		pal = tic_palette_blit(&tic->ram.vram.palette);
+		framebufferPalette(tic, pal);
 	}
 
 	enum {Top = (TIC80_FULLHEIGHT-TIC80_HEIGHT)/2, Bottom = Top};
 	enum {Left = (TIC80_FULLWIDTH-TIC80_WIDTH)/2, Right = Left};
 
-	u32* out = tic->screen;
+	bool border = tic->framebuffer.border;
+	s32 pitch = tic->framebuffer.pitch;
+	u8* row = tic->framebuffer.pixels;
 
-	memset4(&out[0 * TIC80_FULLWIDTH], pal[tic->ram.vram.vars.border], TIC80_FULLWIDTH*Top);
+	if(border)
+		for(s32 r = 0; r < Top; r++, row += pitch)
+			blitFill(tic, row, TIC80_FULLWIDTH, pal[tic->ram.vram.vars.border]);
 
-	u32* rowPtr = out + (Top*TIC80_FULLWIDTH);
-	for(s32 r = 0; r < TIC80_HEIGHT; r++, rowPtr += TIC80_FULLWIDTH)
+	for(s32 r = 0; r < TIC80_HEIGHT; r++, row += pitch)
 	{
-		u32 *colPtr = rowPtr + Left;
-		memset4(rowPtr, pal[tic->ram.vram.vars.border], Left);
-
-		s32 pos = (r + tic->ram.vram.vars.offset.y + TIC80_HEIGHT) % TIC80_HEIGHT * TIC80_WIDTH >> 1;
-
-		u32 x = (-tic->ram.vram.vars.offset.x + TIC80_WIDTH) % TIC80_WIDTH;
-		for(s32 c = 0; c < TIC80_WIDTH / 2; c++)
+		if(border)
 		{
-			u8 val = ((u8*)tic->ram.vram.screen.data)[pos + c];
-			*(colPtr + (x++ % TIC80_WIDTH)) = pal[val & 0xf];
-			*(colPtr + (x++ % TIC80_WIDTH)) = pal[val >> 4];
+			blitFill(tic, row, Left, pal[tic->ram.vram.vars.border]);
+			blitLine(tic, row + framebufferBytes(tic, Left), r, pal);
+			blitFill(tic, row + framebufferBytes(tic, TIC80_FULLWIDTH - Right), Right, pal[tic->ram.vram.vars.border]);
 		}
-
-		memset4(rowPtr + (TIC80_FULLWIDTH-Right), pal[tic->ram.vram.vars.border], Right);
+		else blitLine(tic, row, r, pal);
 			
 		if(scanline && (r < TIC80_HEIGHT-1))
 		{
 			scanline(tic, r+1, data);
-			pal = tic_palette_blit(&tic->ram.vram.palette);
+			framebufferPalette(tic, pal);
 		}
 	}
 
-	memset4(&out[(TIC80_FULLHEIGHT-Bottom) * TIC80_FULLWIDTH], pal[tic->ram.vram.vars.border], TIC80_FULLWIDTH*Bottom);
+	if(border)
+		for(s32 r = 0; r < Bottom; r++, row += pitch)
+			blitFill(tic, row, TIC80_FULLWIDTH, pal[tic->ram.vram.vars.border]);
+
+	memcpy(tic->framebuffer.palette, tic_palette_blit(&tic->ram.vram.palette), sizeof tic->framebuffer.palette);
+
+	if(overline)
+		overline(tic, data);
+
+	TRACE_END("blit");
+}
+
+// runs the SCN and OVR callbacks in the order blit does, for frames that aren't presented
+static void api_blit_callbacks(tic_mem* tic, tic_scanline scanline, tic_overline overline, void* data)
+{
+	tic_machine* machine = (tic_machine*)tic;
+	framebufferPalette(tic, machine->state.ovr.palette);
+
+	if(scanline)
+		for(s32 r = 0; r < TIC80_HEIGHT; r++)
+			scanline(tic, r, data);
 
 	if(overline)
 		overline(tic, data);
@@ -2181,6 +2441,7 @@ static void initApi(tic_api* api)
 	INIT_API(text);
 	INIT_API(fixed_text);
 	INIT_API(text_ex);
+	INIT_API(text_width);
 	INIT_API(clear);
 	INIT_API(pixel);
 	INIT_API(get_pixel);
@@ -2222,6 +2483,7 @@ static void initApi(tic_api* api)
 	INIT_API(tick_start);
 	INIT_API(tick_end);
 	INIT_API(blit);
+	INIT_API(blit_callbacks);
 
 	INIT_API(get_script_config);
 
@@ -2230,8 +2492,8 @@ static void initApi(tic_api* api)
 
 tic_mem* tic_create(s32 samplerate)
 {
-	tic_machine* machine = (tic_machine*)malloc(sizeof(tic_machine));
-	memset(machine, 0, sizeof(tic_machine));
+	// calloc leaves untouched pages (unused banks) to the OS zero page
+	tic_machine* machine = (tic_machine*)calloc(1, sizeof(tic_machine));
 
 	if(machine != (tic_machine*)&machine->memory)
 		return NULL;
@@ -2251,6 +2513,11 @@ tic_mem* tic_create(s32 samplerate)
 	blip_set_rates(machine->blip.left, CLOCKRATE, samplerate);
 	blip_set_rates(machine->blip.right, CLOCKRATE, samplerate);
 
+	machine->memory.framebuffer.pixels = machine->memory.screen;
+	machine->memory.framebuffer.pitch = TIC80_FULLWIDTH * sizeof(u32);
+	machine->memory.framebuffer.format = TIC80_PIXEL_ABGR8888;
+	machine->memory.framebuffer.border = true;
+
 	machine->memory.api.reset(&machine->memory);
 
 	return &machine->memory;
@@ -2260,116 +2527,228 @@ static inline bool islineend(char c) {return c == '\n' || c == '\0';}
 static inline bool isalpha_(char c) {return isalpha(c) || c == '_';}
 static inline bool isalnum_(char c) {return isalnum(c) || c == '_';}
 
-void parseCode(const tic_script_config* config, const char* start, u8* color, const tic_code_theme* theme)
+enum {KeywordSlots = 1024, KeywordTables = 8};
+
+typedef enum
 {
-	const char* ptr = start;
+	WordVar,
+	WordKeyword,
+	WordApi,
+} WordType;
 
-	const char* blockCommentStart = NULL;
-	const char* blockStringStart = NULL;
-	const char* blockStdStringStart = NULL;
-	const char* singleCommentStart = NULL;
-	const char* wordStart = NULL;
-	const char* numberStart = NULL;
+typedef struct
+{
+	const char* word;
+	s32 size;
+	WordType type;
+} KeywordSlot;
 
-	while(true)
+// open addressing tables built once per script config, keywords take precedence over api names
+static struct
+{
+	const tic_script_config* config;
+	bool linear;
+	KeywordSlot slots[KeywordSlots];
+} KeywordTable[KeywordTables];
+
+static inline u32 hashWord(const char* word, s32 size)
+{
+	u32 hash = 2166136261u;
+
+	while(size--)
+		hash = (hash ^ (u8)*word++) * 16777619u;
+
+	return hash;
+}
+
+static KeywordSlot* findKeywordSlot(KeywordSlot* slots, const char* word, s32 size)
+{
+	for(u32 i = hashWord(word, size) & (KeywordSlots - 1);; i = (i + 1) & (KeywordSlots - 1))
 	{
-		char c = ptr[0];
+		KeywordSlot* slot = slots + i;
+
+		if(!slot->word || (slot->size == size && memcmp(slot->word, word, size) == 0))
+			return slot;
+	}
+}
+
+static void addKeywords(KeywordSlot* slots, const char* const* words, s32 count, WordType type)
+{
+	for(s32 i = 0; i < count; i++)
+	{
+		s32 size = (s32)strlen(words[i]);
+		KeywordSlot* slot = findKeywordSlot(slots, words[i], size);
+
+		if(!slot->word)
+			*slot = (KeywordSlot){words[i], size, type};
+	}
+}
 
-		if(blockCommentStart)
+static WordType findWordLinear(const tic_script_config* config, const char* word, s32 size)
+{
+	for(s32 i = 0; i < config->keywordsCount; i++)
+		if(size == strlen(config->keywords[i]) && memcmp(word, config->keywords[i], size) == 0)
+			return WordKeyword;
+
+	for(s32 i = 0; i < config->apiCount; i++)
+		if(size == strlen(config->api[i]) && memcmp(word, config->api[i], size) == 0)
+			return WordApi;
+
+	return WordVar;
+}
+
+static WordType findWord(const tic_script_config* config, const char* word, s32 size)
+{
+	for(s32 i = 0; i < KeywordTables; i++)
+	{
+		if(KeywordTable[i].config == NULL)
 		{
-			const char* end = strstr(ptr, config->blockCommentEnd);
+			// keep the load factor under 1/2, otherwise stay with the linear lookup
+			KeywordTable[i].config = config;
+			KeywordTable[i].linear = config->keywordsCount + config->apiCount > KeywordSlots / 2;
 
-			ptr = end ? end + strlen(config->blockCommentEnd) : blockCommentStart + strlen(blockCommentStart);
-			memset(color + (blockCommentStart - start), theme->comment, ptr - blockCommentStart);
-			blockCommentStart = NULL;
-			continue;
+			if(!KeywordTable[i].linear)
+			{
+				addKeywords(KeywordTable[i].slots, config->keywords, config->keywordsCount, WordKeyword);
+				addKeywords(KeywordTable[i].slots, config->api, config->apiCount, WordApi);
+			}
 		}
-		else if(blockStringStart)
+
+		if(KeywordTable[i].config == config)
 		{
-			const char* end = strstr(ptr, config->blockStringEnd);
+			if(KeywordTable[i].linear) break;
 
-			ptr = end ? end + strlen(config->blockStringEnd) : blockStringStart + strlen(blockStringStart);
-			memset(color + (blockStringStart - start), theme->string, ptr - blockStringStart);
-			blockStringStart = NULL;
-			continue;
+			return findKeywordSlot(KeywordTable[i].slots, word, size)->type;
 		}
-		else if(blockStdStringStart)
+	}
+
+	return findWordLinear(config, word, size);
+}
+
+static inline bool startsWith(const char* ptr, const char* tag)
+{
+	return tag && *tag && strncmp(ptr, tag, strlen(tag)) == 0;
+}
+
+static const char* findTagEnd(const char* ptr, const char* tag)
+{
+	for(; !islineend(*ptr); ptr++)
+		if(startsWith(ptr, tag))
+			return ptr + strlen(tag);
+
+	return NULL;
+}
+
+static const char* findQuoteEnd(const char* ptr, char quote)
+{
+	for(; !islineend(*ptr); ptr++)
+		if(*ptr == quote && !(ptr[-1] == '\\' && ptr[-2] != '\\'))
+			return ptr + 1;
+
+	return NULL;
+}
+
+tic_parse_state parseCode(const tic_script_config* config, const char* line, u8* color, const tic_code_theme* theme, tic_parse_state state)
+{
+	const char* ptr = line;
+
+	while(true)
+	{
+		if(state != tic_parse_none)
 		{
-			const char* blockStart = blockStdStringStart+1;
+			const char* end = NULL;
+			u8 value = theme->string;
 
-			while(true)
+			switch(state)
 			{
-				const char* pos = strchr(blockStart, *blockStdStringStart);
-				
-				if(pos)
-				{
-					if(*(pos-1) == '\\' && *(pos-2) != '\\') blockStart = pos + 1;
-					else
-					{
-						ptr = pos + 1;
-						break;
-					}
-				}
-				else
-				{
-					ptr = blockStdStringStart + strlen(blockStdStringStart);
-					break;
-				}
+			case tic_parse_comment:
+				end = findTagEnd(ptr, config->blockCommentEnd);
+				value = theme->comment;
+				break;
+			case tic_parse_string:
+				end = findTagEnd(ptr, config->blockStringEnd);
+				break;
+			default:
+				end = findQuoteEnd(ptr, state == tic_parse_quote ? '"' : '\'');
+				break;
+			}
+
+			if(!end)
+			{
+				end = ptr;
+				while(!islineend(*end)) end++;
+				memset(color + (ptr - line), value, end - ptr + (*end ? 1 : 0));
+				return state;
 			}
 
-			memset(color + (blockStdStringStart - start), theme->string, ptr - blockStdStringStart);
-			blockStdStringStart = NULL;
+			memset(color + (ptr - line), value, end - ptr);
+			ptr = end;
+			state = tic_parse_none;
+			continue;
+		}
+
+		char c = ptr[0];
+
+		if(startsWith(ptr, config->blockCommentStart))
+		{
+			s32 size = (s32)strlen(config->blockCommentStart);
+			memset(color + (ptr - line), theme->comment, size);
+			ptr += size;
+			state = tic_parse_comment;
 			continue;
 		}
-		else if(singleCommentStart)
+		else if(startsWith(ptr, config->blockStringStart))
 		{
-			while(!islineend(*ptr))ptr++;
+			s32 size = (s32)strlen(config->blockStringStart);
+			memset(color + (ptr - line), theme->string, size);
+			ptr += size;
+			state = tic_parse_string;
+			continue;
+		}
+		else if(c == '"' || c == '\'')
+		{
+			color[ptr - line] = theme->string;
+			ptr++;
+			state = c == '"' ? tic_parse_quote : tic_parse_apostrophe;
+			continue;
+		}
+		else if(startsWith(ptr, config->singleComment))
+		{
+			const char* start = ptr;
+			while(!islineend(*ptr)) ptr++;
 
-			memset(color + (singleCommentStart - start), theme->comment, ptr - singleCommentStart);
-			singleCommentStart = NULL;
+			memset(color + (start - line), theme->comment, ptr - start);
 			continue;
 		}
-		else if(wordStart)
+		else if(isalpha_(c))
 		{
+			const char* start = ptr;
 			while(!islineend(*ptr) && isalnum_(*ptr)) ptr++;
 
-			s32 len = ptr - wordStart;
-			bool keyword = false;
-			{
-				for(s32 i = 0; i < config->keywordsCount; i++)
-					if(len == strlen(config->keywords[i]) && memcmp(wordStart, config->keywords[i], len) == 0)
-					{
-						memset(color + (wordStart - start), theme->keyword, len);
-						keyword = true;
-						break;
-					}
-			}
+			s32 size = (s32)(ptr - start);
 
-			if(!keyword)
+			switch(findWord(config, start, size))
 			{
-				for(s32 i = 0; i < config->apiCount; i++)
-					if(len == strlen(config->api[i]) && memcmp(wordStart, config->api[i], len) == 0)
-					{
-						memset(color + (wordStart - start), theme->api, len);
-						break;
-					}
+			case WordKeyword: memset(color + (start - line), theme->keyword, size); break;
+			case WordApi: memset(color + (start - line), theme->api, size); break;
+			default: break;
 			}
-
-			wordStart = NULL;
 			continue;
 		}
-		else if(numberStart)
+		else if(isdigit(c) || (c == '.' && isdigit(ptr[1])))
 		{
+			const char* start = ptr++;
+
 			while(!islineend(*ptr))
 			{
 				char c = *ptr;
 
 				if(isdigit(c)) ptr++;
-				else if(numberStart[0] == '0' 
-					&& (numberStart[1] == 'x' || numberStart[1] == 'X') 
-					&& isxdigit(numberStart[2]))
+				else if(start[0] == '0' 
+					&& (start[1] == 'x' || start[1] == 'X') 
+					&& isxdigit(start[2]))
 				{
-					if((ptr - numberStart < 2) || (ptr - numberStart >= 2 && isxdigit(c))) ptr++;
+					if((ptr - start < 2) || (ptr - start >= 2 && isxdigit(c))) ptr++;
 					else break;
 				}
 				else if(c == '.' || c == 'e' || c == 'E')
@@ -2380,54 +2759,16 @@ void parseCode(const tic_script_config* config, const char* start, u8* color, co
 				else break;
 			}
 
-			memset(color + (numberStart - start), theme->number, ptr - numberStart);
-			numberStart = NULL;
+			memset(color + (start - line), theme->number, ptr - start);
 			continue;
 		}
-		else
-		{
-			if(config->blockCommentStart && memcmp(ptr, config->blockCommentStart, strlen(config->blockCommentStart)) == 0)
-			{
-				blockCommentStart = ptr;
-				ptr += strlen(config->blockCommentStart);
-				continue;
-			}
-			if(config->blockStringStart && memcmp(ptr, config->blockStringStart, strlen(config->blockStringStart)) == 0)
-			{
-				blockStringStart = ptr;
-				ptr += strlen(config->blockStringStart);
-				continue;
-			}
-			else if(c == '"' || c == '\'')
-			{
-				blockStdStringStart = ptr;
-				ptr++;
-				continue;
-			}
-			else if(config->singleComment && memcmp(ptr, config->singleComment, strlen(config->singleComment)) == 0)
-			{
-				singleCommentStart = ptr;
-				ptr += strlen(config->singleComment);
-				continue;
-			}
-			else if(isalpha_(c))
-			{
-				wordStart = ptr;
-				ptr++;
-				continue;
-			}
-			else if(isdigit(c) || (c == '.' && isdigit(ptr[1])))
-			{
-				numberStart = ptr;
-				ptr++;
-				continue;
-			}
-			else if(ispunct(c)) color[ptr - start] = theme->sign;
-			else if(iscntrl(c)) color[ptr - start] = theme->other;
-		}
+		else if(ispunct(c)) color[ptr - line] = theme->sign;
+		else if(iscntrl(c)) color[ptr - line] = theme->other;
 
-		if(!c) break;
+		if(islineend(c)) break;
 
 		ptr++;
 	}
+
+	return tic_parse_none;
 }
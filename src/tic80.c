@@ -26,6 +26,8 @@
 #include <tic80.h>
 #include "ticapi.h"
 #include "tools.h"
+#include "machine.h"
+#include "replay.h"
 
 #include "ext/gif.h"
 
@@ -109,14 +111,19 @@ TIC80_API void tic80_load(tic80* tic, void* cart, s32 size)
 	}
 
 	{
-		tic80->memory->api.load(&tic80->memory->cart, cart, size);
+		tic80->cart = replay_cart_hash(cart, size);
+		((tic_machine*)tic80->memory)->resident |= tic80->memory->api.load(&tic80->memory->cart, cart, size);
 		tic80->memory->api.reset(tic80->memory);
 	}
 }
 
-TIC80_API void tic80_tick(tic80* tic, tic80_input input)
+TIC80_API void tic80_step(tic80* tic, tic80_input input, u32 flags)
 {
 	tic80_local* tic80 = (tic80_local*)tic;
+	tic_machine* machine = (tic_machine*)tic80->memory;
+
+	// replay hashes cover the samples, a recorded frame is always synthesized
+	machine->sound.skip = (flags & TIC80_SKIP_AUDIO) && !tic80->replay;
 
 	tic80->memory->ram.input = input;
 	
@@ -124,16 +131,322 @@ TIC80_API void tic80_tick(tic80* tic, tic80_input input)
 	tic80->memory->api.tick(tic80->memory, &tic80->tickData);
 	tic80->memory->api.tick_end(tic80->memory);
 
-	tic80->memory->api.blit(tic80->memory, tic80->memory->api.scanline, tic80->memory->api.overline, NULL);
+	if(flags & TIC80_SKIP_BLIT)
+		tic80->memory->api.blit_callbacks(tic80->memory, tic80->memory->api.scanline, tic80->memory->api.overline, NULL);
+	else
+		tic80->memory->api.blit(tic80->memory, tic80->memory->api.scanline, tic80->memory->api.overline, NULL);
+
+	// hashed after SCN/OVR ran, the same point tic80-replay verifies at
+	if(tic80->replay)
+		replay_record(tic80->replay, &input, tic80->memory);
 
 	TickCounter++;
 }
 
+TIC80_API void tic80_tick(tic80* tic, tic80_input input)
+{
+	tic80_step(tic, input, 0);
+}
+
+TIC80_API void tic80_run_frames(tic80* tic, tic80_input input, s32 frames, u32 flags)
+{
+	for(s32 i = 1; i < frames; i++)
+		tic80_step(tic, input, TIC80_SKIP_BLIT | TIC80_SKIP_AUDIO);
+
+	if(frames > 0)
+		tic80_step(tic, input, flags);
+}
+
 TIC80_API void tic80_delete(tic80* tic)
 {
 	tic80_local* tic80 = (tic80_local*)tic;
 
 	tic_close(tic80->memory);
+	replay_delete(tic80->replay);
 
 	free(tic80);
 }
+
+TIC80_API void tic80_record_start(tic80* tic, u32 seed)
+{
+	tic80_local* tic80 = (tic80_local*)tic;
+
+	replay_delete(tic80->replay);
+	tic80->replay = replay_create(tic80->cart, seed, REPLAY_HASH_PERIOD, ((tic_machine*)tic80->memory)->samplerate);
+
+	replay_seed(seed);
+}
+
+TIC80_API void* tic80_record_stop(tic80* tic, u32* size)
+{
+	tic80_local* tic80 = (tic80_local*)tic;
+	void* data = NULL;
+
+	*size = 0;
+
+	if(tic80->replay)
+	{
+		data = replay_save(tic80->replay, size);
+
+		replay_delete(tic80->replay);
+		tic80->replay = NULL;
+	}
+
+	return data;
+}
+
+TIC80_API void tic80_set_framebuffer(tic80* tic, void* pixels, s32 pitch, tic80_pixel_format format, bool border)
+{
+	tic_mem* memory = ((tic80_local*)tic)->memory;
+
+	if(!pixels)
+	{
+		pixels = memory->screen;
+		pitch = TIC80_FULLWIDTH * sizeof(u32);
+		format = TIC80_PIXEL_ABGR8888;
+		border = true;
+	}
+
+	memory->framebuffer.pixels = pixels;
+	memory->framebuffer.pitch = pitch;
+	memory->framebuffer.format = format;
+	memory->framebuffer.border = border;
+}
+
+TIC80_API const u32* tic80_palette(tic80* tic)
+{
+	return ((tic80_local*)tic)->memory->framebuffer.palette;
+}
+
+TIC80_API u32 tic80_resident_size(tic80* tic)
+{
+	tic80_local* tic80 = (tic80_local*)tic;
+	const tic_cartridge* cart = &tic80->memory->cart;
+	u8 resident = ((tic_machine*)tic80->memory)->resident;
+
+	u32 size = sizeof(tic80_local) + sizeof(tic_machine) - sizeof(tic_cartridge) + tic80->memory->samples.size;
+
+	for(s32 i = 0; i < TIC_BANKS; i++)
+		if(resident & (1 << i))
+			size += sizeof(tic_bank);
+
+	size += sizeof(tic_code) + sizeof(s32) + cart->cover.size;
+
+	return size;
+}
+
+#define STATE_MAGIC "TICS"
+#define STATE_VERSION 1
+
+typedef struct
+{
+	u8* data;
+	u32 size;
+	u32 pos;
+	bool load;
+	bool error;
+} StateIO;
+
+static void stateBytes(StateIO* io, void* value, u32 size)
+{
+	if(io->data)
+	{
+		if(io->error || io->pos + size > io->size)
+		{
+			io->error = true;
+			return;
+		}
+
+		if(io->load) memcpy(value, io->data + io->pos, size);
+		else memcpy(io->data + io->pos, value, size);
+	}
+
+	io->pos += size;
+}
+
+static void stateU32(StateIO* io, u32* value)
+{
+	u8 bytes[] = {*value, *value >> 8, *value >> 16, *value >> 24};
+
+	stateBytes(io, bytes, sizeof bytes);
+
+	if(io->load && !io->error)
+		*value = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (u32)bytes[3] << 24;
+}
+
+static void stateS32(StateIO* io, s32* value)
+{
+	stateU32(io, (u32*)value);
+}
+
+static void stateU64(StateIO* io, u64* value)
+{
+	u32 lo = (u32)*value, hi = (u32)(*value >> 32);
+
+	stateU32(io, &lo);
+	stateU32(io, &hi);
+
+	if(io->load && !io->error)
+		*value = (u64)hi << 32 | lo;
+}
+
+static void stateU8(StateIO* io, u8* value)
+{
+	stateBytes(io, value, sizeof *value);
+}
+
+static void stateBool(StateIO* io, bool* value)
+{
+	u8 byte = *value;
+	stateU8(io, &byte);
+	*value = byte != 0;
+}
+
+static void stateChannel(StateIO* io, tic_channel_data* channel)
+{
+	stateS32(io, &channel->tick);
+	stateBytes(io, channel->pos.data, sizeof channel->pos.data);
+	stateS32(io, &channel->index);
+	stateS32(io, &channel->note);
+
+	u8 volume = channel->volume.left | channel->volume.right << 4;
+	stateU8(io, &volume);
+	channel->volume.left = volume;
+	channel->volume.right = volume >> 4;
+
+	u8 speed = channel->speed;
+	stateU8(io, &speed);
+	channel->speed = (s8)speed;
+
+	stateS32(io, &channel->duration);
+}
+
+static void stateCommand(StateIO* io, tic_command_data* command, const tic_music* music)
+{
+	u8 notes = command->chord.note1 | command->chord.note2 << 4;
+	stateS32(io, &command->chord.tick);
+	stateU8(io, &notes);
+	command->chord.note1 = notes;
+	command->chord.note2 = notes >> 4;
+
+	u8 vibrato = command->vibrato.period | command->vibrato.depth << 4;
+	stateS32(io, &command->vibrato.tick);
+	stateU8(io, &vibrato);
+	command->vibrato.period = vibrato;
+	command->vibrato.depth = vibrato >> 4;
+
+	stateS32(io, &command->slide.tick);
+	stateU8(io, &command->slide.note);
+	stateS32(io, &command->slide.duration);
+
+	stateS32(io, &command->finepitch.value);
+
+	// the delayed row points into the music data, it's stored as an offset
+	s32 row = command->delay.row ? (s32)((const u8*)command->delay.row - (const u8*)music) : -1;
+	stateS32(io, &row);
+	command->delay.row = row >= 0 && row + sizeof(tic_track_row) <= sizeof(tic_music) 
+		? (const tic_track_row*)((const u8*)music + row) 
+		: NULL;
+
+	stateS32(io, &command->delay.ticks);
+}
+
+static void stateMachine(StateIO* io, tic80_local* tic80)
+{
+	tic_machine* machine = (tic_machine*)tic80->memory;
+	tic_machine_state_data* state = &machine->state;
+	const tic_music* music = machine->sound.music ? machine->sound.music : &machine->memory.ram.music;
+
+	{
+		char magic[] = STATE_MAGIC;
+		u32 version = STATE_VERSION;
+
+		stateBytes(io, magic, sizeof magic - 1);
+		stateU32(io, &version);
+
+		if(io->load && (memcmp(magic, STATE_MAGIC, sizeof magic - 1) || version != STATE_VERSION))
+			io->error = true;
+	}
+
+	stateU64(io, &TickCounter);
+
+	// RAM is kept as the byte image peek and poke see
+	stateBytes(io, machine->memory.ram.data, sizeof machine->memory.ram.data);
+
+	stateU32(io, &state->gamepads.previous.data);
+	for(s32 i = 0; i < COUNT_OF(state->gamepads.holds); i++)
+		stateU32(io, &state->gamepads.holds[i]);
+
+	stateBytes(io, state->keyboard.previous.keys, sizeof state->keyboard.previous.keys);
+	for(s32 i = 0; i < COUNT_OF(state->keyboard.holds); i++)
+		stateU32(io, &state->keyboard.holds[i]);
+
+	stateS32(io, &state->clip.l);
+	stateS32(io, &state->clip.t);
+	stateS32(io, &state->clip.r);
+	stateS32(io, &state->clip.b);
+
+	for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+	{
+		tic_sound_register_data* regs[] = {&state->registers.left[i], &state->registers.right[i]};
+
+		for(s32 r = 0; r < COUNT_OF(regs); r++)
+		{
+			stateS32(io, &regs[r]->time);
+			stateS32(io, &regs[r]->phase);
+			stateS32(io, &regs[r]->amp);
+		}
+	}
+
+	for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+		stateChannel(io, &state->channels[i]);
+
+	stateS32(io, &state->music.ticks);
+
+	for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+	{
+		stateChannel(io, &state->music.channels[i]);
+		stateCommand(io, &state->music.commands[i], music);
+	}
+
+	stateBool(io, &state->music.jump.active);
+	stateS32(io, &state->music.jump.frame);
+	stateS32(io, &state->music.jump.row);
+
+	stateU32(io, &state->synced);
+}
+
+TIC80_API u32 tic80_state_size(tic80* tic)
+{
+	StateIO io = {0};
+	stateMachine(&io, (tic80_local*)tic);
+
+	return io.pos;
+}
+
+TIC80_API u32 tic80_save_state(tic80* tic, void* buffer, u32 size)
+{
+	StateIO io = {.data = buffer, .size = size};
+	stateMachine(&io, (tic80_local*)tic);
+
+	return io.error ? 0 : io.pos;
+}
+
+TIC80_API bool tic80_load_state(tic80* tic, const void* buffer, u32 size)
+{
+	tic80_local* tic80 = (tic80_local*)tic;
+
+	// the layout is fixed per version, so a short buffer is rejected before anything is touched
+	if(size < tic80_state_size(tic))
+		return false;
+
+	StateIO io = {.data = (u8*)buffer, .size = size, .load = true};
+	stateMachine(&io, tic80);
+
+	// the band-limited synth keeps its tail privately, it restarts from the restored registers
+	tic_machine* machine = (tic_machine*)tic80->memory;
+	blip_clear(machine->blip.left);
+	blip_clear(machine->blip.right);
+
+	return !io.error;
+}
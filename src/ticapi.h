@@ -47,6 +47,17 @@ typedef void(*ErrorOutput)(void*, const char*);
 typedef void(*ExitCallback)(void*);
 typedef bool(*CheckForceExit)(void*);
 
+// script samples taken every 'period' instructions, hits are counted per line
+// and per function, both indexed by line number - 1
+typedef struct
+{
+	u32 period;
+	u32 samples;
+
+	u32 lines[TIC_CODE_SIZE];
+	u32 functions[TIC_CODE_SIZE];
+} tic_profile;
+
 typedef struct
 {
 	TraceOutput trace;
@@ -63,6 +74,8 @@ typedef struct
 
 	void (*preprocessor)(void* data, char* dst);
 
+	tic_profile* profile;
+
 	void* data;
 } tic_tick_data;
 
@@ -89,6 +102,16 @@ typedef struct
 	u8 other;
 } tic_code_theme;
 
+// lexer state carried from the end of one line to the start of the next
+typedef enum
+{
+	tic_parse_none,
+	tic_parse_comment,
+	tic_parse_string,
+	tic_parse_quote,
+	tic_parse_apostrophe,
+} tic_parse_state;
+
 typedef struct tic_script_config tic_script_config;
 
 struct tic_script_config
@@ -104,7 +127,7 @@ struct tic_script_config
 	};
 
 	const tic_outline_item* (*getOutline)(const char* code, s32* size);
-	void (*parse)(const tic_script_config* config, const char* start, u8* color, const tic_code_theme* theme);
+	tic_parse_state (*parse)(const tic_script_config* config, const char* line, u8* color, const tic_code_theme* theme, tic_parse_state state);
 	void (*eval)(tic_mem* tic, const char* code);
 
 	const char* blockCommentStart;
@@ -126,6 +149,7 @@ typedef struct
 	s32  (*text)				(tic_mem* memory, const char* text, s32 x, s32 y, u8 color, bool alt);
 	s32  (*fixed_text)			(tic_mem* memory, const char* text, s32 x, s32 y, u8 color, bool alt);
 	s32  (*text_ex)				(tic_mem* memory, const char* text, s32 x, s32 y, u8 color, bool fixed, s32 scale, bool alt);
+	s32  (*text_width)			(tic_mem* memory, const char* text, bool fixed, s32 scale, bool alt);
 	void (*clear)				(tic_mem* memory, u8 color);
 	void (*pixel)				(tic_mem* memory, s32 x, s32 y, u8 color);
 	u8   (*get_pixel)			(tic_mem* memory, s32 x, s32 y);
@@ -163,12 +187,13 @@ typedef struct
 	bool (*key)					(tic_mem* memory, tic_key key);
 	bool (*keyp)				(tic_mem* memory, tic_key key, s32 hold, s32 period);
 
-	void (*load)				(tic_cartridge* rom, const u8* buffer, s32 size);
+	u8 (*load)					(tic_cartridge* rom, const u8* buffer, s32 size);
 	s32  (*save)				(const tic_cartridge* rom, u8* buffer);
 
 	void (*tick_start)			(tic_mem* memory, const tic_sfx* sfx, const tic_music* music);
 	void (*tick_end)			(tic_mem* memory);
 	void (*blit)				(tic_mem* tic, tic_scanline scanline, tic_overline overline, void* data);
+	void (*blit_callbacks)		(tic_mem* tic, tic_scanline scanline, tic_overline overline, void* data);
 
 	const tic_script_config* (*get_script_config)(tic_mem* memory);
 } tic_api;
@@ -201,6 +226,17 @@ struct tic_mem
 	} samples;
 
 	u32 screen[TIC80_FULLWIDTH * TIC80_FULLHEIGHT];
+
+	// where blit and OVR write, the screen above unless the embedder provides a buffer
+	struct
+	{
+		void* pixels;
+		s32 pitch;
+		tic80_pixel_format format;
+		bool border;
+
+		u32 palette[TIC_PALETTE_SIZE];
+	} framebuffer;
 };
 
 tic_mem* tic_create(s32 samplerate);
@@ -211,4 +247,7 @@ typedef struct
 	tic80 tic;
 	tic_mem* memory;
 	tic_tick_data tickData;
+
+	u32 cart;
+	struct Replay* replay;
 } tic80_local;
@@ -111,6 +111,14 @@ bool tic_tool_has_ext(const char* name, const char* ext)
 	return strcmp(name + strlen(name) - strlen(ext), ext) == 0;
 }
 
+bool tic_tool_empty(const void* buffer, s32 size)
+{
+	const u8* data = (const u8*)buffer;
+
+	// reading never written memory doesn't make it resident, writing zeros does
+	return size <= 0 || (data[0] == 0 && memcmp(data, data + 1, size - 1) == 0);
+}
+
 s32 tic_get_track_row_sfx(const tic_track_row* row)
 {
 	return (row->sfxhi << MUSIC_SFXID_LOW_BITS) | row->sfxlow;
@@ -53,5 +53,6 @@ void tic_tool_set_pattern_id(tic_track* track, s32 frame, s32 channel, s32 id);
 u32 tic_tool_find_closest_color(const tic_rgb* palette, const tic_rgb* color);
 u32* tic_palette_blit(const tic_palette* src);
 bool tic_tool_has_ext(const char* name, const char* ext);
+bool tic_tool_empty(const void* buffer, s32 size);
 s32 tic_get_track_row_sfx(const tic_track_row* row);
 void tic_set_track_row_sfx(tic_track_row* row, s32 sfx);
@@ -0,0 +1,113 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "tracing.h"
+
+#include <stdio.h>
+
+#define TRACING_EVENTS 4096
+
+typedef struct
+{
+	const char* name;
+	char phase;
+	u64 time;
+} TracingEvent;
+
+static struct
+{
+	FILE* file;
+
+	TracingClock counter;
+	TracingClock freq;
+	u64 start;
+
+	TracingEvent events[TRACING_EVENTS];
+	s32 count;
+	bool first;
+} Tracing;
+
+static void flush()
+{
+	double scale = 1000000.0 / Tracing.freq();
+
+	for(s32 i = 0; i < Tracing.count; i++)
+	{
+		const TracingEvent* event = &Tracing.events[i];
+
+		fprintf(Tracing.file, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":0}",
+			Tracing.first ? "" : ",", event->name, event->phase, (event->time - Tracing.start) * scale);
+
+		Tracing.first = false;
+	}
+
+	Tracing.count = 0;
+}
+
+bool tracing_start(const char* path, TracingClock counter, TracingClock freq)
+{
+	tracing_stop();
+
+	Tracing.file = fopen(path, "w");
+
+	if(Tracing.file)
+	{
+		Tracing.counter = counter;
+		Tracing.freq = freq;
+		Tracing.start = counter();
+		Tracing.count = 0;
+		Tracing.first = true;
+
+		fputs("{\"traceEvents\":[", Tracing.file);
+	}
+
+	return Tracing.file != NULL;
+}
+
+void tracing_stop()
+{
+	if(Tracing.file)
+	{
+		flush();
+
+		fputs("\n]}\n", Tracing.file);
+		fclose(Tracing.file);
+
+		Tracing.file = NULL;
+	}
+}
+
+bool tracing_active()
+{
+	return Tracing.file != NULL;
+}
+
+void tracing_event(const char* name, char phase)
+{
+	if(!Tracing.file) return;
+
+	// the file is only touched every few thousand events so writes don't show up as phases
+	if(Tracing.count == TRACING_EVENTS)
+		flush();
+
+	Tracing.events[Tracing.count++] = (TracingEvent){name, phase, Tracing.counter()};
+}
@@ -0,0 +1,45 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <tic80_types.h>
+
+// Frame phases in the Chrome trace event format, the file opens in chrome://tracing or ui.perfetto.dev.
+// The TRACE_ macros only cost something in builds with TIC80_TRACING and record nothing until a trace
+// is started. Names must be string literals. The event buffer isn't locked, so only the main thread
+// may emit events, worker threads (pmem writer, gif encoder) show up where the main thread waits on them.
+
+typedef u64(*TracingClock)();
+
+bool tracing_start(const char* path, TracingClock counter, TracingClock freq);
+void tracing_stop();
+bool tracing_active();
+void tracing_event(const char* name, char phase);
+
+#if defined(TIC80_TRACING)
+#	define TRACE_BEGIN(name) tracing_event(name, 'B')
+#	define TRACE_END(name) tracing_event(name, 'E')
+#else
+#	define TRACE_BEGIN(name)
+#	define TRACE_END(name)
+#endif
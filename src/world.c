@@ -85,46 +85,85 @@ static void tick(World* world)
 	drawGrid(world);
 }
 
-void initWorld(World* world, tic_mem* tic, Map* map)
+static u8 getTileColor(const tic_tile* tile)
 {
-	if(!world->preview)
-		world->preview = malloc(PREVIEW_SIZE);
+	s32 colors[TIC_PALETTE_SIZE] = {0};
 
-	*world = (World)
+	for(s32 p = 0; p < TIC_SPRITESIZE * TIC_SPRITESIZE; p++)
 	{
-		.tic = tic,
-		.map = map,
-		.tick = tick,
-		.preview = world->preview,
-	};
+		u8 color = tic_tool_peek4(tile, p);
 
-	memset(world->preview, 0, PREVIEW_SIZE);
-	s32 colors[TIC_PALETTE_SIZE];
+		if(color)
+			colors[color]++;
+	}
 
-	for(s32 i = 0; i < TIC80_WIDTH * TIC80_HEIGHT; i++)
-	{
-		u8 index = getBankMap()->data[i];
+	s32 max = 0;
 
-		if(index)
-		{
-			memset(colors, 0, sizeof colors);
+	for(s32 c = 0; c < COUNT_OF(colors); c++)
+		if(colors[c] > colors[max]) max = c;
 
-			tic_tile* tile = &getBankTiles()->data[index];
+	return max;
+}
 
-			for(s32 p = 0; p < TIC_SPRITESIZE * TIC_SPRITESIZE; p++)
-			{
-				u8 color = tic_tool_peek4(tile, p);
+static void updatePreview(World* world)
+{
+	struct WorldCache* cache = world->cache;
+	const tic_tiles* tiles = getBankTiles();
+	const tic_map* map = getBankMap();
 
-				if(color)
-					colors[color]++;
-			}
+	bool remap = !cache->valid;
 
-			s32 max = 0;
+	for(s32 i = 0; i < TIC_BANK_SPRITES; i++)
+	{
+		if(cache->valid && memcmp(&cache->tiles.data[i], &tiles->data[i], sizeof(tic_tile)) == 0)
+			continue;
 
-			for(s32 c = 0; c < COUNT_OF(colors); c++)
-				if(colors[c] > colors[max]) max = c;
+		u8 color = getTileColor(&tiles->data[i]);
 
-			tic_tool_poke4(world->preview, i, max);
+		if(!cache->valid || cache->colors[i] != color)
+		{
+			cache->colors[i] = color;
+			remap = true;
 		}
 	}
-}
\ No newline at end of file
+
+	// empty cells stay transparent whatever tile 0 holds
+	cache->colors[0] = 0;
+
+	for(s32 i = 0; i < TIC_MAP_WIDTH * TIC_MAP_HEIGHT; i++)
+		if(remap || cache->map.data[i] != map->data[i])
+			tic_tool_poke4(world->preview, i, cache->colors[map->data[i]]);
+
+	cache->tiles = *tiles;
+	cache->map = *map;
+	cache->valid = true;
+}
+
+void initWorld(World* world, tic_mem* tic, Map* map)
+{
+	if(!world->preview)
+		world->preview = malloc(PREVIEW_SIZE);
+
+	if(!world->cache)
+	{
+		world->cache = malloc(sizeof *world->cache);
+		world->cache->valid = false;
+	}
+
+	*world = (World)
+	{
+		.tic = tic,
+		.map = map,
+		.tick = tick,
+		.preview = world->preview,
+		.cache = world->cache,
+	};
+
+	updatePreview(world);
+}
+
+void freeWorld(World* world)
+{
+	free(world->preview);
+	free(world->cache);
+}
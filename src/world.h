@@ -34,7 +34,17 @@ struct World
 
 	void* preview;
 
+	// tiles and map the preview was built from, with the dominant color of every tile
+	struct WorldCache
+	{
+		bool valid;
+		tic_tiles tiles;
+		tic_map map;
+		u8 colors[TIC_BANK_SPRITES];
+	}* cache;
+
 	void(*tick)(World* world);
 };
 
-void initWorld(World* world, tic_mem* tic, Map* map);
\ No newline at end of file
+void initWorld(World* world, tic_mem* tic, Map* map);
+void freeWorld(World* world);
\ No newline at end of file
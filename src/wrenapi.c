@@ -114,6 +114,7 @@ class TIC {\n\
 	foreign static map_height__\n\
 	foreign static spritesize__\n\
 	foreign static print__(v, x, y, color, fixed, scale, alt)\n\
+	foreign static textwidth__(v, fixed, scale, alt)\n\
 	foreign static trace__(msg, color)\n\
 	foreign static spr__(id, x, y, alpha_color, scale, flip, rotate)\n\
 	foreign static mgeti__(index)\n\
@@ -123,6 +124,10 @@ class TIC {\n\
 	static print(v,x,y,color,fixed) { TIC.print__(v.toString, x, y, color, fixed, 1, false) }\n\
 	static print(v,x,y,color,fixed,scale) { TIC.print__(v.toString, x, y, color, fixed, scale, false) }\n\
 	static print(v,x,y,color,fixed,scale,alt) { TIC.print__(v.toString, x, y, color, fixed, scale, alt) }\n\
+	static textwidth(v) { TIC.textwidth__(v.toString, false, 1, false) }\n\
+	static textwidth(v,fixed) { TIC.textwidth__(v.toString, fixed, 1, false) }\n\
+	static textwidth(v,fixed,scale) { TIC.textwidth__(v.toString, fixed, scale, false) }\n\
+	static textwidth(v,fixed,scale,alt) { TIC.textwidth__(v.toString, fixed, scale, alt) }\n\
 	static trace(v) { TIC.trace__(v.toString, 15) }\n\
 	static trace(v,color) { TIC.trace__(v.toString, color) }\n\
 	static map(cell_x, cell_y, cell_w, cell_h, x, y, alpha_color, scale, remap) {\n\
@@ -410,6 +415,18 @@ static void wren_print(WrenVM* vm)
 	wrenSetSlotDouble(vm, 0, size);
 }
 
+static void wren_textwidth(WrenVM* vm)
+{
+	tic_mem* memory = (tic_mem*)getWrenMachine(vm);
+
+	const char* text = wrenGetSlotString(vm, 1);
+	bool fixed = wrenGetSlotBool(vm, 2);
+	s32 scale = getWrenNumber(vm, 3);
+	bool alt = wrenGetSlotBool(vm, 4);
+
+	wrenSetSlotDouble(vm, 0, memory->api.text_width(memory, text, fixed, scale, alt));
+}
+
 static void wren_font(WrenVM* vm)
 {
 	tic_mem* memory = (tic_mem*)getWrenMachine(vm);
@@ -1199,6 +1216,7 @@ static WrenForeignMethodFn foreignTicMethods(const char* signature)
 	if (strcmp(signature, "static TIC.map_height__"               ) == 0) return wren_map_height;
 	if (strcmp(signature, "static TIC.spritesize__"               ) == 0) return wren_spritesize;
 	if (strcmp(signature, "static TIC.print__(_,_,_,_,_,_,_)"     ) == 0) return wren_print;
+	if (strcmp(signature, "static TIC.textwidth__(_,_,_,_)"       ) == 0) return wren_textwidth;
 	if (strcmp(signature, "static TIC.trace__(_,_)"             ) == 0) return wren_trace;
 	if (strcmp(signature, "static TIC.spr__(_,_,_,_,_,_,_)"	    ) == 0) return wren_spr_internal;
 	if (strcmp(signature, "static TIC.mgeti__(_)"                 ) == 0) return wren_mgeti;